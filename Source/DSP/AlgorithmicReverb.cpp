@@ -1,20 +1,14 @@
 #include "AlgorithmicReverb.h"
 
-AlgorithmicReverb::AlgorithmicReverb()
-{
-    // Initialize diffusers with default max delay
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i] = DSPUtils::AllpassFilter(4096);
-        diffusersR[i] = DSPUtils::AllpassFilter(4096);
-    }
-}
-
 void AlgorithmicReverb::prepare(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
+    // Diffuser arena, sized for the longest stage at full size
+    int maxDiffuserDelay = static_cast<int>(std::ceil(809 * 1.08f * sampleRate / 44100.0)) + 1;
+    diffusers.prepare(numDiffusers, maxDiffuserDelay, sampleRate);
+
     // Allocate pre-delay buffer (up to 500ms)
     int maxPreDelaySamples = static_cast<int>(sampleRate * 0.5);
     preDelayBufferL.resize(maxPreDelaySamples, 0.0f);
@@ -37,10 +31,10 @@ void AlgorithmicReverb::prepare(double sampleRate, int samplesPerBlock)
     // Setup filters
     auto hpCoeffs = DSPUtils::calcHighPass(sampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(sampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
+
+    loopEnergy.prepare(sampleRate);
 
     updateParameters();
     reset();
@@ -63,17 +57,12 @@ void AlgorithmicReverb::reset()
         fdnFilterStates[i] = 0.0f;
     }
 
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i].reset();
-        diffusersR[i].reset();
-    }
+    diffusers.reset();
 
-    highPassL.reset();
-    highPassR.reset();
-    lowPassL.reset();
-    lowPassR.reset();
+    highPass.reset();
+    lowPass.reset();
 
+    loopEnergy.reset();
     lfoPhase = 0.0f;
 }
 
@@ -127,19 +116,16 @@ void AlgorithmicReverb::updateParameters()
     for (int i = 0; i < numDiffusers; ++i)
     {
         int delay = static_cast<int>(diffuserDelays[i] * size * currentSampleRate / 44100.0);
-        diffusersL[i].setDelay(std::clamp(delay, 1, 4095));
-        diffusersR[i].setDelay(std::clamp(static_cast<int>(delay * 1.08f), 1, 4095)); // Stereo offset
-        diffusersL[i].setFeedback(0.3f + diffusion * 0.4f);
-        diffusersR[i].setFeedback(0.3f + diffusion * 0.4f);
+        diffusers.setDelay(i, delay, static_cast<int>(delay * 1.08f)); // Stereo offset
     }
+    diffusers.setFeedback(0.3f + diffusion * 0.4f);
+    diffusers.setTopology(diffuserTopology);
 
     // Update filters
     auto hpCoeffs = DSPUtils::calcHighPass(currentSampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(currentSampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // LFO for modulation
     lfoPhaseIncrement = modRate / static_cast<float>(currentSampleRate);
@@ -220,7 +206,11 @@ void AlgorithmicReverb::processFDN(float inputL, float inputR, float& outL, floa
     avgDelay /= fdnSize;
 
     float feedback;
-    if (freeze || decaySeconds >= 30.0f)
+    if (freeze)
+    {
+        feedback = 1.0f; // Lossless: the Hadamard mix is orthonormal
+    }
+    else if (decaySeconds >= 30.0f)
     {
         feedback = 0.999f; // Nearly infinite
     }
@@ -230,15 +220,18 @@ void AlgorithmicReverb::processFDN(float inputL, float inputR, float& outL, floa
         feedback = std::clamp(feedback, 0.0f, 0.999f);
     }
 
+    // Damping is bypassed while frozen so the loop holds its spectrum
+    const float loopDamping = freeze ? 0.0f : damping;
+
     // Apply damping (low-pass on feedback) and write back to delay lines
     for (int i = 0; i < fdnSize; ++i)
     {
         // Damping filter
-        float dampedOutput = mixedOutputs[i] * (1.0f - damping) + fdnFilterStates[i] * damping;
+        float dampedOutput = mixedOutputs[i] * (1.0f - loopDamping) + fdnFilterStates[i] * loopDamping;
         fdnFilterStates[i] = dampedOutput;
 
         // Add input and write to delay line
-        float feedbackSample = dampedOutput * feedback;
+        float feedbackSample = loopEnergy.process(dampedOutput * feedback);
         float newSample = (i < 4) ? inputL * 0.25f + feedbackSample : inputR * 0.25f + feedbackSample;
 
         int bufSize = static_cast<int>(fdnDelayLines[i].size());
@@ -248,24 +241,17 @@ void AlgorithmicReverb::processFDN(float inputL, float inputR, float& outL, floa
         if (fdnWriteIndices[i] >= bufSize) fdnWriteIndices[i] = 0;
     }
 
-    // Sum outputs for stereo
+    // Even lines to the left, odd lines to the right. Width is applied to
+    // the finished wet signal by the processor.
     outL = 0.0f;
     outR = 0.0f;
-    for (int i = 0; i < fdnSize; ++i)
+    for (int i = 0; i < fdnSize; i += 2)
     {
-        if (i % 2 == 0)
-        {
-            outL += mixedOutputs[i];
-            outR += mixedOutputs[i] * (1.0f - width) + mixedOutputs[(i + 1) % fdnSize] * width;
-        }
-        else
-        {
-            outR += mixedOutputs[i];
-            outL += mixedOutputs[i] * (1.0f - width) + mixedOutputs[(i + 1) % fdnSize] * width;
-        }
+        outL += mixedOutputs[i];
+        outR += mixedOutputs[i + 1];
     }
-    outL *= 0.25f;
-    outR *= 0.25f;
+    outL *= 0.5f;
+    outR *= 0.5f;
 }
 
 void AlgorithmicReverb::process(juce::AudioBuffer<float>& buffer)
@@ -273,65 +259,82 @@ void AlgorithmicReverb::process(juce::AudioBuffer<float>& buffer)
     if (bypassed)
         return;
 
-    updateParameters();
+    if (takeParameterChanges())
+        updateParameters();
 
     auto* leftChannel = buffer.getWritePointer(0);
     auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
 
     int numSamples = buffer.getNumSamples();
     int preDelayBufSize = static_cast<int>(preDelayBufferL.size());
 
-    for (int sample = 0; sample < numSamples; ++sample)
+    // Work in short slices so the diffusers can run a stage at a time
+    for (int start = 0; start < numSamples; start += diffusionBlockSize)
     {
-        float inputL = leftChannel[sample];
-        float inputR = rightChannel ? rightChannel[sample] : inputL;
+        const int sliceSize = std::min(diffusionBlockSize, numSamples - start);
+        float* sliceL = leftChannel + start;
+        float* sliceR = rightChannel ? rightChannel + start : nullptr;
+        const float* sliceRightInput = rightInput ? rightInput + start : nullptr;
+
+        // Input filtering and pre-delay
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float inputL = sliceL[sample];
+            float inputR = sliceRightInput ? sliceRightInput[sample] : inputL;
 
-        // Apply input high-pass filter
-        inputL = highPassL.process(inputL);
-        inputR = highPassR.process(inputR);
+            // Apply input high-pass filter, once for a mono source
+            if (sliceRightInput)
+                highPass.process(inputL, inputR);
+            else
+                inputL = highPass.processMono(inputL);
 
-        // Pre-delay
-        preDelayBufferL[preDelayWriteIndex] = inputL;
-        preDelayBufferR[preDelayWriteIndex] = inputR;
+            // Pre-delay
+            preDelayBufferL[preDelayWriteIndex] = inputL;
+            if (sliceRightInput)
+                preDelayBufferR[preDelayWriteIndex] = inputR;
 
-        int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
-        if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
+            int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
+            if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
 
-        float delayedL = preDelayBufferL[preDelayReadIndex];
-        float delayedR = preDelayBufferR[preDelayReadIndex];
+            // A mono source splits into left and right at the diffusers
+            diffusionL[sample] = preDelayBufferL[preDelayReadIndex];
+            diffusionR[sample] = sliceRightInput ? preDelayBufferR[preDelayReadIndex] : diffusionL[sample];
 
-        preDelayWriteIndex++;
-        if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+            preDelayWriteIndex++;
+            if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+        }
 
         // Input diffusion
-        for (int i = 0; i < numDiffusers; ++i)
-        {
-            delayedL = diffusersL[i].process(delayedL);
-            delayedR = diffusersR[i].process(delayedR);
-        }
+        diffusers.processBlock(diffusionL.data(), diffusionR.data(), sliceSize);
 
-        // Early reflections
-        float earlyL, earlyR;
-        processEarlyReflections(delayedL, delayedR, earlyL, earlyR);
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            // Input into the reverb fades out while frozen
+            float tankInputGain = loopEnergy.getNextInputGain();
+            float delayedL = diffusionL[sample] * tankInputGain;
+            float delayedR = diffusionR[sample] * tankInputGain;
 
-        // FDN (late reverb)
-        float lateL, lateR;
-        processFDN(delayedL, delayedR, lateL, lateR);
+            // Early reflections
+            float earlyL, earlyR;
+            processEarlyReflections(delayedL, delayedR, earlyL, earlyR);
 
-        // Combine early and late
-        float wetL = earlyL + lateL;
-        float wetR = earlyR + lateR;
+            // FDN (late reverb)
+            float lateL, lateR;
+            processFDN(delayedL, delayedR, lateL, lateR);
 
-        // Apply output low-pass filter
-        wetL = lowPassL.process(wetL);
-        wetR = lowPassR.process(wetR);
+            // Combine early and late
+            float wetL = earlyL + lateL;
+            float wetR = earlyR + lateR;
 
-        // Mix dry/wet
-        float dryL = leftChannel[sample];
-        float dryR = rightChannel ? rightChannel[sample] : dryL;
+            // Apply output low-pass filter
+            lowPass.process(wetL, wetR);
 
-        leftChannel[sample] = dryL * (1.0f - mix) + wetL * mix;
-        if (rightChannel)
-            rightChannel[sample] = dryR * (1.0f - mix) + wetR * mix;
+            sliceL[sample] = wetL;
+            if (sliceR)
+                sliceR[sample] = wetR;
+        }
     }
+
+    loopEnergy.endBlock();
 }
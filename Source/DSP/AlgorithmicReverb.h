@@ -17,8 +17,6 @@ enum class AlgorithmicMode
 class AlgorithmicReverb : public ReverbBase
 {
 public:
-    AlgorithmicReverb();
-
     void prepare(double sampleRate, int samplesPerBlock) override;
     void process(juce::AudioBuffer<float>& buffer) override;
     void reset() override;
@@ -56,18 +54,22 @@ private:
     std::array<int, fdnSize> fdnWriteIndices;
     std::array<float, fdnSize> fdnFilterStates;
 
-    // Allpass diffusers (4 per channel)
+    // Allpass diffusers (4 stereo stages)
     static constexpr int numDiffusers = 4;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersL;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersR;
+    DSPUtils::DiffuserBank diffusers;
+
+    // Diffusion runs on slices of this many samples, a stage at a time
+    static constexpr int diffusionBlockSize = 64;
+    std::array<float, diffusionBlockSize> diffusionL {};
+    std::array<float, diffusionBlockSize> diffusionR {};
 
     // Modulation LFOs
     float lfoPhase = 0.0f;
     float lfoPhaseIncrement = 0.0f;
 
     // Input/output filters
-    DSPUtils::BiquadFilter highPassL, highPassR;
-    DSPUtils::BiquadFilter lowPassL, lowPassR;
+    DSPUtils::StereoBiquad highPass;
+    DSPUtils::StereoBiquad lowPass;
 
     // Hadamard matrix for FDN mixing (8x8 normalized)
     static constexpr float hadamard[8][8] = {
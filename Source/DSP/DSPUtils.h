@@ -2,6 +2,10 @@
 
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 namespace DSPUtils
 {
@@ -16,6 +20,22 @@ namespace DSPUtils
         return std::pow(10.0f, dB / 20.0f);
     }
 
+    // decibelsToLinear for per-sample gain curves, within 0.001dB. Works as
+    // 2^(dB * log2(10) / 20): the whole part goes straight into the float
+    // exponent and a cubic covers the fraction.
+    inline float fastDecibelsToLinear(float dB)
+    {
+        const float exponent = std::max(dB * 0.166096405f, -126.0f);
+        const float whole = std::floor(exponent);
+        const float frac = exponent - whole;
+        const float mantissa = 1.0f + frac * (0.695556856f + frac * (0.226173572f + frac * 0.0781455737f));
+
+        const std::uint32_t bits = static_cast<std::uint32_t>(static_cast<int>(whole) + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return mantissa * scale;
+    }
+
     // Range mapping
     inline float mapRange(float value, float inMin, float inMax, float outMin, float outMax)
     {
@@ -33,6 +53,60 @@ namespace DSPUtils
         return std::clamp(sample, -threshold, threshold);
     }
 
+    // Rational tanh approximation, x(27 + x^2) / (27 + 9x^2).
+    // Reaches exactly +-1 at |x| = 3 and is clamped beyond that.
+    inline float fastTanh(float x)
+    {
+        x = std::clamp(x, -3.0f, 3.0f);
+        float x2 = x * x;
+        return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+    }
+
+    // Antiderivative of fastTanh: x^2/18 + (4/3) ln(1 + x^2/3), linear past the clamp.
+    // Anti-aliasing divides the difference of two nearby values by a small
+    // step, so it is zero at the origin and worked out in double, where a
+    // float would lose most of the difference to rounding.
+    inline double fastTanhIntegral(float x)
+    {
+        const double ax = std::abs(static_cast<double>(x));
+        if (ax >= 3.0)
+            return ax - 3.0 + 0.5 + (4.0 / 3.0) * std::log(4.0);
+        return ax * ax / 18.0 + (4.0 / 3.0) * std::log1p(ax * ax / 3.0);
+    }
+
+    // fastTanh with first-order antiderivative anti-aliasing.
+    // Works sample by sample, so it can sit inside a feedback loop where
+    // block-based oversampling cannot. Adds half a sample of delay.
+    class AntiAliasedSaturator
+    {
+    public:
+        float process(float input)
+        {
+            float delta = input - previousInput;
+            double integral = fastTanhIntegral(input);
+
+            float output;
+            if (std::abs(delta) > 1.0e-4f)
+                output = static_cast<float>((integral - previousIntegral) / delta);
+            else
+                output = fastTanh(0.5f * (input + previousInput));
+
+            previousInput = input;
+            previousIntegral = integral;
+            return output;
+        }
+
+        void reset()
+        {
+            previousInput = 0.0f;
+            previousIntegral = 0.0;
+        }
+
+    private:
+        float previousInput = 0.0f;
+        double previousIntegral = 0.0;
+    };
+
     // One-pole filter coefficient
     inline float calculateCoefficient(double sampleRate, float timeMs)
     {
@@ -40,6 +114,135 @@ namespace DSPUtils
         return 1.0f - std::exp(-1.0f / (static_cast<float>(sampleRate) * timeMs * 0.001f));
     }
 
+    // Linear parameter ramp of a fixed length in samples. Each value is
+    // worked out from the samples left in the ramp rather than accumulated,
+    // so a ramp lands on the same values whether it is read per sample, in
+    // blocks or skipped through, and renders do not depend on buffer size.
+    // The first target after prepare() is jumped to, so a freshly prepared
+    // processor starts at its parameter values instead of gliding to them.
+    class LinearSmoother
+    {
+    public:
+        explicit LinearSmoother(float initialValue = 0.0f)
+            : current(initialValue), target(initialValue) {}
+
+        void prepare(double sampleRate, float rampMs)
+        {
+            rampLength = std::max(1, static_cast<int>(sampleRate * rampMs * 0.001));
+            remaining = 0;
+            current = target;
+            snapToNextTarget = true;
+        }
+
+        void setTarget(float newTarget)
+        {
+            if (snapToNextTarget)
+            {
+                snapToNextTarget = false;
+                setCurrentAndTarget(newTarget);
+                return;
+            }
+
+            if (newTarget == target)
+                return;
+
+            target = newTarget;
+            remaining = rampLength;
+            step = (target - current) / static_cast<float>(rampLength);
+        }
+
+        void setCurrentAndTarget(float value)
+        {
+            current = target = value;
+            remaining = 0;
+        }
+
+        bool isSmoothing() const { return remaining > 0; }
+        float getCurrent() const { return current; }
+        float getTarget() const { return target; }
+
+        float getNext()
+        {
+            if (remaining > 0)
+                current = target - step * static_cast<float>(--remaining);
+            return current;
+        }
+
+        // The next numSamples values. Once the ramp is over this is a plain
+        // fill, and the ramp part is a loop without branches.
+        void fill(float* dest, int numSamples)
+        {
+            const int ramp = std::min(remaining, numSamples);
+            for (int n = 0; n < ramp; ++n)
+                dest[n] = target - step * static_cast<float>(remaining - 1 - n);
+
+            skip(ramp);
+            std::fill(dest + ramp, dest + numSamples, current);
+        }
+
+        // Moves numSamples along the ramp and returns the value reached, for
+        // parameters that are only applied once per sub-block
+        float skip(int numSamples)
+        {
+            if (remaining > 0)
+            {
+                remaining -= std::min(remaining, numSamples);
+                current = target - step * static_cast<float>(remaining);
+            }
+            return current;
+        }
+
+    private:
+        float current;
+        float target;
+        float step = 0.0f;
+        int rampLength = 1;
+        int remaining = 0;
+        bool snapToNextTarget = false;
+    };
+
+    // Fast xorshift32 noise source. Cheap enough to give every voice its own
+    // generator, so voices are uncorrelated and no shared state is touched.
+    class FastNoise
+    {
+    public:
+        explicit FastNoise(uint32_t seed = 0x9e3779b9u) { setSeed(seed); }
+
+        void setSeed(uint32_t seed)
+        {
+            state = seed != 0 ? seed : 0x9e3779b9u;
+        }
+
+        uint32_t nextInt()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        // Uniform in [0, 1)
+        float nextFloat()
+        {
+            return static_cast<float>(nextInt() >> 8) * (1.0f / 16777216.0f);
+        }
+
+        // Uniform in [-1, 1)
+        float nextBipolar()
+        {
+            return nextFloat() * 2.0f - 1.0f;
+        }
+
+        void fill(float* dest, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = nextBipolar();
+        }
+
+    private:
+        uint32_t state = 0x9e3779b9u;
+    };
+
     // Allpass filter for reverb
     class AllpassFilter
     {
@@ -80,6 +283,24 @@ namespace DSPUtils
             return output;
         }
 
+        // Canonical Schroeder form with unity gain at all frequencies.
+        // process() colours and amplifies, which is fine on an input path but
+        // makes a feedback loop that contains it grow.
+        float processUnity(float input)
+        {
+            int readIndex = writeIndex - delay;
+            if (readIndex < 0) readIndex += maxDelayLength;
+
+            float delayed = buffer[readIndex];
+            float v = input + delayed * feedback;
+            buffer[writeIndex] = v;
+
+            writeIndex++;
+            if (writeIndex >= maxDelayLength) writeIndex = 0;
+
+            return delayed - v * feedback;
+        }
+
     private:
         std::vector<float> buffer;
         int maxDelayLength;
@@ -88,6 +309,398 @@ namespace DSPUtils
         float feedback = 0.5f;
     };
 
+    // Diffuser chain topologies for DiffuserBank
+    enum class DiffuserTopology
+    {
+        Classic,    // Series Schroeder stages in the engines' original form (-x + delayed)
+        Unity,      // Series unity-gain allpasses, safe inside a feedback loop
+        Nested,     // Stages pair up Dattorro-style, the odd stage inside the even one's delay
+        Modulated   // Unity allpasses whose delays drift slowly in quadrature L/R
+    };
+
+    // Stereo allpass diffuser chain. Every stage lives in one contiguous arena
+    // (stage-major, L/R interleaved, power-of-two stride sized in prepare()),
+    // and all stages share one write index. processBlock() runs a whole block
+    // through one stage before moving to the next, so each stage's lines stay
+    // in cache; process() is the same code for a single sample.
+    class DiffuserBank
+    {
+    public:
+        static constexpr int maxStages = 8;
+
+        void prepare(int numStagesToUse, int maxDelaySamples, double sampleRate)
+        {
+            numStages = std::clamp(numStagesToUse, 1, maxStages);
+
+            // Modulated stages swing a few samples either side of their delay
+            modDepth = 6.0f * static_cast<float>(sampleRate / 44100.0);
+
+            stride = 1;
+            while (stride < maxDelaySamples + static_cast<int>(modDepth) + 2)
+                stride <<= 1;
+            mask = stride - 1;
+            arena.assign(static_cast<size_t>(numStages) * stride * 2, 0.0f);
+
+            // Slightly different slow rates per stage so the drifts never line up
+            for (int stage = 0; stage < maxStages; ++stage)
+            {
+                float w = 2.0f * 3.14159265358979323846f * (0.5f + 0.17f * stage) / static_cast<float>(sampleRate);
+                lfoStepCos[stage] = std::cos(w);
+                lfoStepSin[stage] = std::sin(w);
+            }
+
+            reset();
+        }
+
+        void setTopology(DiffuserTopology newTopology)
+        {
+            topology = newTopology;
+        }
+
+        void setDelay(int stage, int delayLeft, int delayRight)
+        {
+            delays[stage][0] = std::clamp(delayLeft, 1, mask);
+            delays[stage][1] = std::clamp(delayRight, 1, mask);
+        }
+
+        void setFeedback(float fb)
+        {
+            feedback = std::clamp(fb, 0.0f, 0.99f);
+        }
+
+        void reset()
+        {
+            std::fill(arena.begin(), arena.end(), 0.0f);
+            writeIndex = 0;
+            for (int stage = 0; stage < maxStages; ++stage)
+            {
+                float phase = 1.3f * stage;
+                lfoCos[stage] = std::cos(phase);
+                lfoSin[stage] = std::sin(phase);
+            }
+        }
+
+        void process(float& left, float& right)
+        {
+            processBlock(&left, &right, 1);
+        }
+
+        void processBlock(float* left, float* right, int numSamples)
+        {
+            switch (topology)
+            {
+                case DiffuserTopology::Classic:
+                    for (int stage = 0; stage < numStages; ++stage)
+                        processClassicStage(stage, left, right, numSamples);
+                    break;
+
+                case DiffuserTopology::Unity:
+                    for (int stage = 0; stage < numStages; ++stage)
+                        processUnityStage(stage, left, right, numSamples);
+                    break;
+
+                case DiffuserTopology::Nested:
+                {
+                    int stage = 0;
+                    for (; stage + 1 < numStages; stage += 2)
+                        processNestedPair(stage, left, right, numSamples);
+                    if (stage < numStages)
+                        processUnityStage(stage, left, right, numSamples);
+                    break;
+                }
+
+                case DiffuserTopology::Modulated:
+                    for (int stage = 0; stage < numStages; ++stage)
+                        processModulatedStage(stage, left, right, numSamples);
+                    break;
+            }
+
+            writeIndex = (writeIndex + numSamples) & mask;
+        }
+
+    private:
+        float* line(int stage) { return arena.data() + static_cast<size_t>(stage) * stride * 2; }
+
+        float read(const float* data, int w, int delay, int ch) const
+        {
+            return data[2 * ((w - delay) & mask) + ch];
+        }
+
+        // Linear interpolation, for the modulated stages
+        float readFraction(const float* data, int w, float delay, int ch) const
+        {
+            delay = std::clamp(delay, 1.0f, static_cast<float>(mask - 1));
+            const int whole = static_cast<int>(delay);
+            const float frac = delay - static_cast<float>(whole);
+            float a = data[2 * ((w - whole) & mask) + ch];
+            float b = data[2 * ((w - whole - 1) & mask) + ch];
+            return a + (b - a) * frac;
+        }
+
+        void processClassicStage(int stage, float* left, float* right, int numSamples)
+        {
+            float* data = line(stage);
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const int w = (writeIndex + n) & mask;
+                const std::array<float, 2> input { left[n], right[n] };
+                const std::array<float, 2> delayed { read(data, w, delays[stage][0], 0),
+                                                     read(data, w, delays[stage][1], 1) };
+                std::array<float, 2> output;
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    data[2 * w + ch] = input[ch] + delayed[ch] * feedback;
+                    output[ch] = -input[ch] + delayed[ch];
+                }
+                left[n] = output[0];
+                right[n] = output[1];
+            }
+        }
+
+        void processUnityStage(int stage, float* left, float* right, int numSamples)
+        {
+            float* data = line(stage);
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const int w = (writeIndex + n) & mask;
+                const std::array<float, 2> input { left[n], right[n] };
+                const std::array<float, 2> delayed { read(data, w, delays[stage][0], 0),
+                                                     read(data, w, delays[stage][1], 1) };
+                std::array<float, 2> output;
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    float v = input[ch] + delayed[ch] * feedback;
+                    data[2 * w + ch] = v;
+                    output[ch] = delayed[ch] - v * feedback;
+                }
+                left[n] = output[0];
+                right[n] = output[1];
+            }
+        }
+
+        // Outer allpass whose delay path runs through the inner one. Both are
+        // allpass, so the pair is too, but its echo density grows much faster.
+        void processNestedPair(int stage, float* left, float* right, int numSamples)
+        {
+            float* outer = line(stage);
+            float* inner = line(stage + 1);
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const int w = (writeIndex + n) & mask;
+                const std::array<float, 2> input { left[n], right[n] };
+                std::array<float, 2> output;
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    float outerDelayed = read(outer, w, delays[stage][ch], ch);
+                    float innerDelayed = read(inner, w, delays[stage + 1][ch], ch);
+
+                    float innerV = outerDelayed + innerDelayed * feedback;
+                    inner[2 * w + ch] = innerV;
+                    float innerOut = innerDelayed - innerV * feedback;
+
+                    float v = input[ch] + innerOut * feedback;
+                    outer[2 * w + ch] = v;
+                    output[ch] = innerOut - v * feedback;
+                }
+                left[n] = output[0];
+                right[n] = output[1];
+            }
+        }
+
+        void processModulatedStage(int stage, float* left, float* right, int numSamples)
+        {
+            float* data = line(stage);
+            float c = lfoCos[stage];
+            float s = lfoSin[stage];
+            for (int n = 0; n < numSamples; ++n)
+            {
+                // Rotate the LFO phasor; left follows the sine, right the cosine
+                float nextC = c * lfoStepCos[stage] - s * lfoStepSin[stage];
+                s = s * lfoStepCos[stage] + c * lfoStepSin[stage];
+                c = nextC;
+
+                const int w = (writeIndex + n) & mask;
+                const std::array<float, 2> input { left[n], right[n] };
+                const std::array<float, 2> delayed {
+                    readFraction(data, w, delays[stage][0] + modDepth * s, 0),
+                    readFraction(data, w, delays[stage][1] + modDepth * c, 1) };
+                std::array<float, 2> output;
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    float v = input[ch] + delayed[ch] * feedback;
+                    data[2 * w + ch] = v;
+                    output[ch] = delayed[ch] - v * feedback;
+                }
+                left[n] = output[0];
+                right[n] = output[1];
+            }
+
+            // Keep the phasor on the unit circle
+            float norm = 1.5f - 0.5f * (c * c + s * s);
+            lfoCos[stage] = c * norm;
+            lfoSin[stage] = s * norm;
+        }
+
+        std::vector<float> arena;
+        int numStages = 1;
+        int stride = 1;
+        int mask = 0;
+        int writeIndex = 0;
+        std::array<std::array<int, 2>, maxStages> delays {};
+        float feedback = 0.5f;
+        DiffuserTopology topology = DiffuserTopology::Classic;
+
+        float modDepth = 0.0f;
+        std::array<float, maxStages> lfoCos {};
+        std::array<float, maxStages> lfoSin {};
+        std::array<float, maxStages> lfoStepCos {};
+        std::array<float, maxStages> lfoStepSin {};
+    };
+
+    // Mono delay line for block-based networks. The buffer is a power of two
+    // so every read wraps with a mask. process() delays a block in place;
+    // peek() and addTap() read a whole block at a fixed offset in one pass,
+    // which lets a network run stage by stage instead of sample by sample.
+    class BlockDelay
+    {
+    public:
+        void prepare(int maxDelaySamples, int maxBlockSize)
+        {
+            int size = 1;
+            while (size < maxDelaySamples + maxBlockSize + 2)
+                size <<= 1;
+            mask = size - 1;
+            buffer.assign(static_cast<size_t>(size), 0.0f);
+            reset();
+        }
+
+        void setDelay(int delaySamples)
+        {
+            delay = std::clamp(delaySamples, 1, mask);
+        }
+
+        int getDelay() const { return delay; }
+
+        void reset()
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            writeIndex = 0;
+        }
+
+        // Sample pushed `age` samples ago (age 1 = the newest)
+        float read(int age) const
+        {
+            return buffer[(writeIndex - age) & mask];
+        }
+
+        // Linear interpolation between whole ages
+        float readFraction(float age) const
+        {
+            age = std::clamp(age, 1.0f, static_cast<float>(mask - 1));
+            const int whole = static_cast<int>(age);
+            const float frac = age - static_cast<float>(whole);
+            float a = read(whole);
+            float b = read(whole + 1);
+            return a + (b - a) * frac;
+        }
+
+        void push(float input)
+        {
+            buffer[writeIndex] = input;
+            writeIndex = (writeIndex + 1) & mask;
+        }
+
+        void process(float* data, int numSamples)
+        {
+            for (int n = 0; n < numSamples; ++n)
+            {
+                float delayed = read(delay);
+                push(data[n]);
+                data[n] = delayed;
+            }
+        }
+
+        // Pushes a block without reading it back, for a line that is only
+        // read through peek() and addTap()
+        void write(const float* data, int numSamples)
+        {
+            for (int n = 0; n < numSamples; ++n)
+                push(data[n]);
+        }
+
+        // What process() will output for the next numSamples samples, before
+        // they are pushed. Only valid while numSamples <= the delay.
+        void peek(float* output, int numSamples) const
+        {
+            for (int n = 0; n < numSamples; ++n)
+                output[n] = read(delay - n);
+        }
+
+        // Adds gain * (the line's input `age` samples before each sample of
+        // the numSamples block just pushed) to output
+        void addTap(float* output, int numSamples, int age, float gain) const
+        {
+            for (int n = 0; n < numSamples; ++n)
+                output[n] += gain * read(numSamples - n + age);
+        }
+
+    private:
+        std::vector<float> buffer;
+        int mask = 0;
+        int delay = 1;
+        int writeIndex = 0;
+    };
+
+    // Unity-gain Schroeder allpass on a BlockDelay. A negative feedback flips
+    // the sign, as in Dattorro's decay diffusers. processModulated() sweeps
+    // the delay per sample by a fractional offset for a chorused tank.
+    class BlockAllpass
+    {
+    public:
+        void prepare(int maxDelaySamples, int maxBlockSize)
+        {
+            line.prepare(maxDelaySamples, maxBlockSize);
+        }
+
+        void setDelay(int delaySamples) { line.setDelay(delaySamples); }
+        void setFeedback(float fb) { feedback = std::clamp(fb, -0.99f, 0.99f); }
+        void reset() { line.reset(); }
+
+        void process(float* data, int numSamples)
+        {
+            const int delay = line.getDelay();
+            for (int n = 0; n < numSamples; ++n)
+            {
+                float delayed = line.read(delay);
+                float v = data[n] + delayed * feedback;
+                line.push(v);
+                data[n] = delayed - v * feedback;
+            }
+        }
+
+        void processModulated(float* data, const float* modulation, int numSamples)
+        {
+            const float delay = static_cast<float>(line.getDelay());
+            for (int n = 0; n < numSamples; ++n)
+            {
+                float delayed = line.readFraction(delay + modulation[n]);
+                float v = data[n] + delayed * feedback;
+                line.push(v);
+                data[n] = delayed - v * feedback;
+            }
+        }
+
+        // Taps the allpass's internal line, see BlockDelay::addTap()
+        void addTap(float* output, int numSamples, int age, float gain) const
+        {
+            line.addTap(output, numSamples, age, gain);
+        }
+
+    private:
+        BlockDelay line;
+        float feedback = 0.5f;
+    };
+
     // Comb filter for reverb
     class CombFilter
     {
@@ -237,6 +850,38 @@ namespace DSPUtils
         float z1 = 0.0f;
     };
 
+    // Stereo pair of OnePoleFilters with shared coefficients
+    class StereoOnePole
+    {
+    public:
+        void setCutoff(double sampleRate, float freqHz)
+        {
+            float w = 2.0f * 3.14159265358979323846f * freqHz / static_cast<float>(sampleRate);
+            a0 = w / (1.0f + w);
+            b1 = 1.0f - a0;
+        }
+
+        void reset()
+        {
+            z1.fill(0.0f);
+        }
+
+        void process(float& left, float& right)
+        {
+            const std::array<float, 2> input { left, right };
+            for (int ch = 0; ch < 2; ++ch)
+                z1[ch] = input[ch] * a0 + z1[ch] * b1;
+
+            left = z1[0];
+            right = z1[1];
+        }
+
+    private:
+        float a0 = 0.1f;
+        float b1 = 0.9f;
+        std::array<float, 2> z1 {};
+    };
+
     // One-pole high-pass filter
     class OnePoleLPHPFilter
     {
@@ -359,6 +1004,58 @@ namespace DSPUtils
         float y1 = 0.0f, y2 = 0.0f;
     };
 
+    // Stereo pair of BiquadFilters with shared coefficients. The state is
+    // kept per lane so both channels update in the same instruction stream.
+    class StereoBiquad
+    {
+    public:
+        void setCoefficients(const BiquadCoeffs& coeffs)
+        {
+            c = coeffs;
+        }
+
+        void reset()
+        {
+            x1.fill(0.0f);
+            x2.fill(0.0f);
+            y1.fill(0.0f);
+            y2.fill(0.0f);
+        }
+
+        void process(float& left, float& right)
+        {
+            const std::array<float, 2> input { left, right };
+            std::array<float, 2> output;
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                output[ch] = c.b0 * input[ch] + c.b1 * x1[ch] + c.b2 * x2[ch] - c.a1 * y1[ch] - c.a2 * y2[ch];
+                x2[ch] = x1[ch];
+                x1[ch] = input[ch];
+                y2[ch] = y1[ch];
+                y1[ch] = output[ch];
+            }
+
+            left = output[0];
+            right = output[1];
+        }
+
+        // Mono source: runs the left lane only
+        float processMono(float input)
+        {
+            float output = c.b0 * input + c.b1 * x1[0] + c.b2 * x2[0] - c.a1 * y1[0] - c.a2 * y2[0];
+            x2[0] = x1[0];
+            x1[0] = input;
+            y2[0] = y1[0];
+            y1[0] = output;
+            return output;
+        }
+
+    private:
+        BiquadCoeffs c;
+        std::array<float, 2> x1 {}, x2 {};
+        std::array<float, 2> y1 {}, y2 {};
+    };
+
     // Envelope follower for ducking
     class EnvelopeFollower
     {
@@ -393,4 +1090,563 @@ namespace DSPUtils
         float releaseCoeff = 0.01f;
         float envelope = 0.0f;
     };
+
+    enum class DuckerDetection
+    {
+        Peak = 0,   // Instantaneous level of the louder channel
+        RMS         // Mean square of both channels over ~10ms
+    };
+
+    // Downward compressor for the reverb return, keyed from a separate
+    // signal. It runs a block at a time in stages: detection, the static
+    // curve in decibels, attack and release on the gain reduction, then back
+    // to a linear gain. Only detection and the ballistics carry state from
+    // sample to sample; the curve and the conversions are plain loops.
+    class Ducker
+    {
+    public:
+        void prepare(double sampleRate)
+        {
+            currentSampleRate = sampleRate;
+            rmsCoeff = calculateCoefficient(sampleRate, 10.0f);
+            updateBallistics();
+            reset();
+        }
+
+        void reset()
+        {
+            meanSquare = 0.0f;
+            reductionDb = 0.0f;
+        }
+
+        void setThreshold(float thresholdDecibels) { thresholdDb = thresholdDecibels; }
+        void setRatio(float ratio) { slope = 1.0f - 1.0f / std::max(1.0f, ratio); }
+        void setDetection(DuckerDetection mode) { detection = mode; }
+
+        void setAttack(float timeMs)
+        {
+            attackMs = timeMs;
+            updateBallistics();
+        }
+
+        void setRelease(float timeMs)
+        {
+            releaseMs = timeMs;
+            updateBallistics();
+        }
+
+        // Wet gains for numSamples of key. depth scales the reduction per
+        // sample (0 = none, 1 = the full ratio) and may be the gains array.
+        void process(const float* keyL, const float* keyR, const float* depth, float* gains, int numSamples)
+        {
+            for (int start = 0; start < numSamples; start += chunkSize)
+            {
+                const int count = std::min(chunkSize, numSamples - start);
+                const float* left = keyL + start;
+                const float* right = keyR + start;
+
+                // Detector level as power
+                if (detection == DuckerDetection::Peak)
+                {
+                    for (int i = 0; i < count; ++i)
+                        levels[i] = std::max(left[i] * left[i], right[i] * right[i]);
+                }
+                else
+                {
+                    for (int i = 0; i < count; ++i)
+                    {
+                        const float power = (left[i] * left[i] + right[i] * right[i]) * 0.5f;
+                        meanSquare += rmsCoeff * (power - meanSquare);
+                        levels[i] = meanSquare;
+                    }
+                }
+
+                // Static curve: the reduction asked for above the threshold
+                for (int i = 0; i < count; ++i)
+                {
+                    const float levelDb = 10.0f * std::log10(levels[i] + 1.0e-12f);
+                    levels[i] = std::max(0.0f, levelDb - thresholdDb) * slope;
+                }
+
+                // Ballistics, attack while the reduction grows
+                for (int i = 0; i < count; ++i)
+                {
+                    const float coeff = levels[i] > reductionDb ? attackCoeff : releaseCoeff;
+                    reductionDb += coeff * (levels[i] - reductionDb);
+                    levels[i] = reductionDb;
+                }
+
+                for (int i = 0; i < count; ++i)
+                    gains[start + i] = fastDecibelsToLinear(-levels[i] * depth[start + i]);
+            }
+        }
+
+    private:
+        void updateBallistics()
+        {
+            attackCoeff = calculateCoefficient(currentSampleRate, attackMs);
+            releaseCoeff = calculateCoefficient(currentSampleRate, releaseMs);
+        }
+
+        static constexpr int chunkSize = 64;
+        std::array<float, chunkSize> levels {};
+
+        double currentSampleRate = 44100.0;
+        DuckerDetection detection = DuckerDetection::Peak;
+        float thresholdDb = -30.0f;
+        float slope = 0.75f;   // 1 - 1/ratio, 4:1
+        float attackMs = 5.0f;
+        float releaseMs = 150.0f;
+        float attackCoeff = 0.1f;
+        float releaseCoeff = 0.01f;
+        float rmsCoeff = 0.01f;
+        float meanSquare = 0.0f;
+        float reductionDb = 0.0f;
+    };
+
+    // Cascade of identical stretched first-order allpasses,
+    // H(z) = (a + z^-K) / (1 + a z^-K), run on several independent lanes at once.
+    // With a < 0 low frequencies are delayed more than high ones below
+    // fs / (2K), which is the dispersion that gives spring tanks their chirp.
+    // State is stored lane-innermost so every stage is a fixed-length loop over
+    // contiguous lanes that the compiler vectorises. Only the first
+    // setNumStages() stages run; the rest are storage for when more are needed.
+    // A change of stage count crossfades between the outputs of the shorter and
+    // the longer cascade, and a further change waits until that fade is over.
+    template <int Lanes, int Stages, int MaxStretch = 16>
+    class StretchedAllpassCascade
+    {
+    public:
+        static_assert((MaxStretch & (MaxStretch - 1)) == 0, "Stretch ring must be a power of two");
+
+        using LaneArray = std::array<float, Lanes>;
+
+        void setStretch(int k)
+        {
+            stretch = std::clamp(k, 1, MaxStretch - 1);
+        }
+
+        void setCoefficient(int lane, float a)
+        {
+            coefficients[lane] = std::clamp(a, -0.95f, 0.95f);
+        }
+
+        // fadeStep is the crossfade increment per sample (1 = switch at once)
+        void setNumStages(int numStages, float fadeStep)
+        {
+            numStages = std::clamp(numStages, 0, Stages);
+            if (numStages == activeStages || stageFade < 1.0f)
+                return;
+
+            // Stages coming back into use start from silence
+            for (int stage = activeStages; stage < numStages; ++stage)
+                for (auto& lanes : state[stage])
+                    lanes.fill(0.0f);
+
+            fadeFromStages = activeStages;
+            activeStages = numStages;
+            stageFadeStep = fadeStep;
+            stageFade = 0.0f;
+        }
+
+        void reset()
+        {
+            for (auto& ring : state)
+                for (auto& lanes : ring)
+                    lanes.fill(0.0f);
+            writePos = 0;
+            stageFade = 1.0f;
+        }
+
+        int getNumStages() const { return activeStages; }
+        bool isFading() const { return stageFade < 1.0f; }
+
+        // Low-frequency group delay of one stage, in samples
+        float getStageDelayAtDC(int lane) const
+        {
+            float a = coefficients[lane];
+            return stretch * (1.0f - a) / (1.0f + a);
+        }
+
+        // Low-frequency group delay of the whole cascade, in samples
+        float getGroupDelayAtDC(int lane) const
+        {
+            return activeStages * getStageDelayAtDC(lane);
+        }
+
+        void process(LaneArray& x)
+        {
+            const int readPos = (writePos - stretch) & (MaxStretch - 1);
+
+            if (stageFade >= 1.0f)
+            {
+                runStages(x, 0, activeStages, readPos);
+            }
+            else
+            {
+                // Both stage counts run; the output moves from one to the other
+                const int shortStages = std::min(activeStages, fadeFromStages);
+                const int longStages = std::max(activeStages, fadeFromStages);
+                runStages(x, 0, shortStages, readPos);
+                const LaneArray shortOutput = x;
+                runStages(x, shortStages, longStages, readPos);
+
+                const float longWeight = activeStages > fadeFromStages ? stageFade : 1.0f - stageFade;
+                for (int lane = 0; lane < Lanes; ++lane)
+                    x[lane] = shortOutput[lane] + (x[lane] - shortOutput[lane]) * longWeight;
+
+                stageFade = std::min(1.0f, stageFade + stageFadeStep);
+            }
+
+            writePos = (writePos + 1) & (MaxStretch - 1);
+        }
+
+    private:
+        void runStages(LaneArray& x, int firstStage, int endStage, int readPos)
+        {
+            for (int stage = firstStage; stage < endStage; ++stage)
+            {
+                const LaneArray& delayed = state[stage][readPos];
+                LaneArray& current = state[stage][writePos];
+
+                for (int lane = 0; lane < Lanes; ++lane)
+                {
+                    float v = x[lane] - coefficients[lane] * delayed[lane];
+                    x[lane] = coefficients[lane] * v + delayed[lane];
+                    current[lane] = v;
+                }
+            }
+        }
+
+        alignas(32) std::array<std::array<LaneArray, MaxStretch>, Stages> state {};
+        alignas(32) LaneArray coefficients {};
+        int stretch = 1;
+        int activeStages = Stages;
+        int fadeFromStages = Stages;
+        float stageFade = 1.0f;      // 0-1, 1 when no crossfade is running
+        float stageFadeStep = 1.0f;
+        int writePos = 0;
+    };
+
+    // Feedback-loop energy control shared by all engines. While frozen it fades
+    // the tank input out, then holds the loop at the RMS it had once the fade
+    // completed. Every loop sample also goes through a soft safety limiter so a
+    // pitch-shifted or modulated loop stays bounded in any mode.
+    // An engine calls process() for every line of its loop, so time is kept by
+    // getNextInputGain(), which runs once per sample however many lines there are.
+    class LoopEnergyControl
+    {
+    public:
+        void prepare(double sampleRate)
+        {
+            inputFadeStep = 1.0f / static_cast<float>(sampleRate * 0.05);  // 50ms input fade
+            measurementWindow = static_cast<int>(sampleRate * 0.01);        // 10ms RMS window
+            maxTrimPerSample = maxTrimPerSecond / static_cast<float>(sampleRate);
+            reset();
+        }
+
+        void setFrozen(bool shouldFreeze)
+        {
+            if (shouldFreeze && !frozen)
+                targetRms = 0.0f;  // recapture once the input has faded out
+
+            frozen = shouldFreeze;
+        }
+
+        void reset()
+        {
+            inputGain = frozen ? 0.0f : 1.0f;
+            energyGain = 1.0f;
+            lossTrim = 1.0f;
+            targetRms = 0.0f;
+            sumSquares = 0.0f;
+            numMeasured = 0;
+            numElapsed = 0;
+        }
+
+        // Gain for signal entering the tank (call once per sample)
+        float getNextInputGain()
+        {
+            ++numElapsed;
+
+            if (frozen)
+                inputGain = std::max(0.0f, inputGain - inputFadeStep);
+            else
+                inputGain = std::min(1.0f, inputGain + inputFadeStep);
+            return inputGain;
+        }
+
+        // Energy correction and safety limiting for one sample written back into the loop
+        float process(float loopSample)
+        {
+            float output = loopSample * energyGain;
+            sumSquares += output * output;
+            ++numMeasured;
+            return limit(output);
+        }
+
+        // Update the energy correction once a full measurement window has
+        // elapsed, however the host splits the blocks
+        void endBlock()
+        {
+            if (numElapsed < measurementWindow)
+                return;
+
+            const int elapsedSamples = numElapsed;
+            float rms = numMeasured > 0 ? std::sqrt(sumSquares / static_cast<float>(numMeasured)) : 0.0f;
+            sumSquares = 0.0f;
+            numMeasured = 0;
+            numElapsed = 0;
+
+            if (!frozen)
+            {
+                energyGain = 1.0f;
+                lossTrim = 1.0f;
+                return;
+            }
+
+            // Wait for the input fade before capturing the level to hold
+            if (inputGain > 0.0f)
+                return;
+
+            if (targetRms <= 0.0f)
+            {
+                targetRms = rms;
+                return;
+            }
+
+            if (rms > 1.0e-9f)
+            {
+                // The loop gain follows the level error directly, within a
+                // small bound, so the level settles instead of swinging round
+                // the target. A slow trim, whose rate is fixed in seconds,
+                // takes up any steady loss in the loop.
+                float correction = targetRms / rms;
+                float maxTrimStep = maxTrimPerSample * static_cast<float>(elapsedSamples);
+                lossTrim = std::clamp(lossTrim * std::clamp(correction, 1.0f - maxTrimStep, 1.0f + maxTrimStep), 0.5f, 2.0f);
+                energyGain = lossTrim * std::clamp(correction, 1.0f - maxCorrection, 1.0f + maxCorrection);
+            }
+        }
+
+        // Transparent below the knee, saturates smoothly towards 2x the knee
+        static float limit(float sample)
+        {
+            constexpr float knee = 2.0f;
+            float magnitude = std::abs(sample);
+            if (magnitude <= knee)
+                return sample;
+
+            float over = magnitude - knee;
+            return std::copysign(knee + over / (1.0f + over / knee), sample);
+        }
+
+    private:
+        static constexpr float maxCorrection = 0.004f;    // Largest loop gain change the level error may apply
+        static constexpr float maxTrimPerSecond = 0.12f;  // +-12% trim per second at most
+
+        bool frozen = false;
+        float inputGain = 1.0f;
+        float inputFadeStep = 0.0005f;
+        int measurementWindow = 441;
+        float maxTrimPerSample = maxTrimPerSecond / 44100.0f;
+        float energyGain = 1.0f;
+        float lossTrim = 1.0f;
+        float targetRms = 0.0f;
+        float sumSquares = 0.0f;
+        int numMeasured = 0;   // Loop samples in sumSquares, one per line per sample
+        int numElapsed = 0;    // Samples since the last measurement
+    };
+
+    // LPC spectral envelope for formant-preserving pitch shifting.
+    // The envelope is re-estimated every analysisHop samples from recent source
+    // material (autocorrelation + Levinson-Durbin), whatever the call size. whiten() flattens a signal with the
+    // analysis lattice A(z) before pitch shifting and recolour() re-applies the
+    // original envelope with the synthesis lattice 1/A(z) afterwards, so the
+    // formants stay where they were while the harmonics move. Lattice form keeps
+    // the synthesis filter stable while coefficients change between blocks.
+    class FormantPreserver
+    {
+    public:
+        static constexpr int order = 12;
+        static constexpr int analysisSize = 1024;
+        static constexpr int analysisHop = 512;
+        static constexpr int numChannels = 2;
+
+        FormantPreserver()
+        {
+            for (int i = 0; i < analysisSize; ++i)
+                window[i] = 0.5f - 0.5f * std::cos(6.283185307179586f * i / analysisSize);
+        }
+
+        void prepare(double sampleRate)
+        {
+            // Gaussian lag window (~80 Hz) widens formant peaks so the
+            // estimate tracks the envelope rather than individual harmonics
+            for (int i = 0; i <= order; ++i)
+            {
+                float x = 6.283185307179586f * 80.0f * i / static_cast<float>(sampleRate);
+                lagWindow[i] = std::exp(-0.5f * x * x);
+            }
+
+            // The envelope hold's reference level falls with a fixed time
+            // constant, one step per hop
+            holdDecay = std::exp(-static_cast<float>(analysisHop) / (static_cast<float>(sampleRate) * holdTimeSeconds));
+
+            reset();
+        }
+
+        void reset()
+        {
+            history.fill(0.0f);
+            historyIndex = 0;
+            hopCount = 0;
+            reflection.fill(0.0f);
+            referenceEnergy = 0.0f;
+            for (auto& state : analysisState) state.fill(0.0f);
+            for (auto& state : synthesisState) state.fill(0.0f);
+            unwhitenedEnergy = whitenedEnergy = shiftedEnergy = recolouredEnergy = 0.0f;
+            targetGain = 1.0f;
+            outputGain = 1.0f;
+        }
+
+        // Returns true when a hop is complete and update() is due
+        bool pushAnalysis(float sample)
+        {
+            history[historyIndex] = sample;
+            historyIndex = (historyIndex + 1) & (analysisSize - 1);
+
+            if (++hopCount < analysisHop)
+                return false;
+
+            hopCount = 0;
+            return true;
+        }
+
+        // Re-estimate the envelope from the last analysisSize samples, once
+        // per hop
+        void update()
+        {
+            // Level-match the whiten/recolour pair over the last block so the
+            // envelope moves energy between bands without adding or removing any
+            if (whitenedEnergy > 1.0e-12f && recolouredEnergy > 1.0e-12f)
+            {
+                float whitenGain = whitenedEnergy / unwhitenedEnergy;
+                float recolourGain = recolouredEnergy / shiftedEnergy;
+                targetGain = std::clamp(1.0f / std::sqrt(whitenGain * recolourGain), 0.25f, 4.0f);
+            }
+
+            unwhitenedEnergy = whitenedEnergy = shiftedEnergy = recolouredEnergy = 0.0f;
+
+            std::array<float, analysisSize> frame;
+            for (int i = 0; i < analysisSize; ++i)
+                frame[i] = history[(historyIndex + i) & (analysisSize - 1)] * window[i];
+
+            std::array<float, order + 1> r;
+            for (int lag = 0; lag <= order; ++lag)
+            {
+                float acc = 0.0f;
+                for (int i = lag; i < analysisSize; ++i)
+                    acc += frame[i] * frame[i - lag];
+                r[lag] = acc * lagWindow[lag];
+            }
+
+            // Hold the last envelope once the source falls 30 dB below its recent
+            // peak, so a tail keeps the formants of the material that fed it
+            // rather than the envelope of filter ringing or noise
+            referenceEnergy = std::max(r[0], referenceEnergy * holdDecay);
+            if (r[0] < referenceEnergy * 1.0e-3f || r[0] < 1.0e-9f)
+                return;
+
+            // White noise correction limits the envelope to ~25 dB of range
+            r[0] *= 1.003f;
+
+            // Levinson-Durbin recursion, keeping the reflection coefficients
+            std::array<float, order + 1> a {};
+            std::array<float, order + 1> previous {};
+            a[0] = 1.0f;
+            float error = r[0];
+
+            for (int i = 1; i <= order; ++i)
+            {
+                float acc = r[i];
+                for (int j = 1; j < i; ++j)
+                    acc += a[j] * r[i - j];
+
+                float k = std::clamp(-acc / error, -0.98f, 0.98f);
+                reflection[i - 1] = k;
+
+                previous = a;
+                for (int j = 1; j < i; ++j)
+                    a[j] = previous[j] + k * previous[i - j];
+                a[i] = k;
+
+                error *= (1.0f - k * k);
+            }
+        }
+
+        // Analysis lattice, A(z)
+        float whiten(float input, int channel)
+        {
+            auto& state = analysisState[channel];
+            float forward = input;
+            float backward = input;
+
+            for (int m = 0; m < order; ++m)
+            {
+                float delayedBackward = state[m];
+                state[m] = backward;
+                float nextForward = forward + reflection[m] * delayedBackward;
+                backward = delayedBackward + reflection[m] * forward;
+                forward = nextForward;
+            }
+
+            unwhitenedEnergy += input * input;
+            whitenedEnergy += forward * forward;
+            return forward;
+        }
+
+        // Synthesis lattice, 1/A(z)
+        float recolour(float input, int channel)
+        {
+            auto& state = synthesisState[channel];
+            float forward = input;
+
+            for (int m = order - 1; m >= 0; --m)
+            {
+                forward -= reflection[m] * state[m];
+                if (m + 1 < order)
+                    state[m + 1] = state[m] + reflection[m] * forward;
+            }
+
+            state[0] = forward;
+
+            shiftedEnergy += input * input;
+            recolouredEnergy += forward * forward;
+            outputGain += (targetGain - outputGain) * 0.002f;
+            return forward * outputGain;
+        }
+
+    private:
+        std::array<float, analysisSize> window;
+        std::array<float, analysisSize> history {};
+        std::array<float, order + 1> lagWindow {};
+        std::array<float, order> reflection {};
+
+        // Delayed backward errors b_m[n-1] per lattice stage
+        std::array<std::array<float, order>, numChannels> analysisState {};
+        std::array<std::array<float, order>, numChannels> synthesisState {};
+
+        int historyIndex = 0;
+        int hopCount = 0;
+        static constexpr float holdTimeSeconds = 0.2f;
+        float holdDecay = 0.95f;
+        float referenceEnergy = 0.0f;
+
+        float unwhitenedEnergy = 0.0f;
+        float whitenedEnergy = 0.0f;
+        float shiftedEnergy = 0.0f;
+        float recolouredEnergy = 0.0f;
+        float targetGain = 1.0f;
+        float outputGain = 1.0f;
+    };
 }
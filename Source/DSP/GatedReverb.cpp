@@ -1,21 +1,25 @@
 #include "GatedReverb.h"
 #include <cmath>
 
-GatedReverb::GatedReverb()
-{
-    // Initialize diffusers
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i] = DSPUtils::AllpassFilter(4096);
-        diffusersR[i] = DSPUtils::AllpassFilter(4096);
-    }
-}
-
 void GatedReverb::prepare(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
+    // Diffuser arena, sized for the longest stage at full size
+    int maxDiffuserDelay = static_cast<int>(std::ceil(503 * 1.1f * sampleRate / 44100.0)) + 1;
+    diffusers.prepare(numDiffusers, maxDiffuserDelay, sampleRate);
+
+    // Allocate lookahead buffer (up to 10ms)
+    int maxLookaheadSamples = static_cast<int>(sampleRate * 0.01) + 1;
+    lookaheadBufferL.resize(maxLookaheadSamples, 0.0f);
+    lookaheadBufferR.resize(maxLookaheadSamples, 0.0f);
+    lookaheadFadeStep = 1.0f / static_cast<float>(sampleRate * 0.005);  // 5ms read head crossfade
+
+    // Release curve, long enough for the slowest linear release
+    releaseCurve.assign(static_cast<size_t>(sampleRate * 0.5) + 2, 0.0f);
+    releaseCurveStale = true;
+
     // Allocate pre-delay buffer
     int maxPreDelaySamples = static_cast<int>(sampleRate * 0.5);
     preDelayBufferL.resize(maxPreDelaySamples, 0.0f);
@@ -47,10 +51,8 @@ void GatedReverb::prepare(double sampleRate, int samplesPerBlock)
     // Setup filters
     auto hpCoeffs = DSPUtils::calcHighPass(sampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(sampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // Mid-frequency boost for 80s character (around 2-3kHz)
     // Simple implementation using peak filter coefficients
@@ -68,8 +70,9 @@ void GatedReverb::prepare(double sampleRate, int samplesPerBlock)
     midCoeffs.a1 = (-2.0f * cosw0) / a0;
     midCoeffs.a2 = (1.0f - alpha / A) / a0;
 
-    midBoostL.setCoefficients(midCoeffs);
-    midBoostR.setCoefficients(midCoeffs);
+    midBoost.setCoefficients(midCoeffs);
+
+    loopEnergy.prepare(sampleRate);
 
     updateParameters();
     reset();
@@ -77,6 +80,12 @@ void GatedReverb::prepare(double sampleRate, int samplesPerBlock)
 
 void GatedReverb::reset()
 {
+    std::fill(lookaheadBufferL.begin(), lookaheadBufferL.end(), 0.0f);
+    std::fill(lookaheadBufferR.begin(), lookaheadBufferR.end(), 0.0f);
+    lookaheadWriteIndex = 0;
+    lookaheadFade = 1.0f;
+    snapLookahead = true;
+
     std::fill(preDelayBufferL.begin(), preDelayBufferL.end(), 0.0f);
     std::fill(preDelayBufferR.begin(), preDelayBufferR.end(), 0.0f);
     preDelayWriteIndex = 0;
@@ -92,26 +101,22 @@ void GatedReverb::reset()
         fdnFilterStates[i] = 0.0f;
     }
 
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i].reset();
-        diffusersR[i].reset();
-    }
+    diffusers.reset();
 
-    highPassL.reset();
-    highPassR.reset();
-    lowPassL.reset();
-    lowPassR.reset();
-    midBoostL.reset();
-    midBoostR.reset();
+    highPass.reset();
+    lowPass.reset();
+    midBoost.reset();
 
     inputEnvelopeL.reset();
     inputEnvelopeR.reset();
+    loopEnergy.reset();
 
+    gateStage = GateStage::Closed;
     gateEnvelope = 0.0f;
     holdCounter = 0;
-    gateOpen = false;
-    currentGateLevel.store(0.0f);
+    releasePosition = 0;
+    keyWasAbove = false;
+    currentGateLevel.store(0.0f, std::memory_order_relaxed);
 }
 
 void GatedReverb::setThreshold(float thresholdDb)
@@ -119,6 +124,12 @@ void GatedReverb::setThreshold(float thresholdDb)
     threshold = std::clamp(thresholdDb, -60.0f, 0.0f);
 }
 
+void GatedReverb::setAttackTime(float attackMs)
+{
+    attackTimeMs = std::clamp(attackMs, 0.0f, 500.0f);
+    updateParameters();
+}
+
 void GatedReverb::setHoldTime(float holdMs)
 {
     holdTimeMs = std::clamp(holdMs, 10.0f, 500.0f);
@@ -133,18 +144,100 @@ void GatedReverb::setReleaseTime(float releaseMs)
 
 void GatedReverb::setGateShape(float shape)
 {
-    gateShape = std::clamp(shape, 0.0f, 1.0f);
+    setParameter(gateShape, std::clamp(shape, 0.0f, 1.0f));
+}
+
+void GatedReverb::setLookahead(float lookaheadMs)
+{
+    this->lookaheadMs = std::clamp(lookaheadMs, 0.0f, 10.0f);
+    updateParameters();
+}
+
+void GatedReverb::setReleaseCurve(GateCurve curve)
+{
+    setParameter(gateCurve, curve);
+}
+
+void GatedReverb::setRetriggerMode(GateRetrigger mode)
+{
+    retriggerMode = mode;
+}
+
+void GatedReverb::startReleaseCurve()
+{
+    // The settings are latched here, so a change during a release only
+    // takes effect on the next one
+    curveReleaseCoeff = releaseCoeff;
+    curveGateShape = gateShape;
+    builtGateCurve = gateCurve;
+    presetCurveLength = static_cast<int>(releaseTimeMs * currentSampleRate / 1000.0);
+    presetCurveLength = std::clamp(presetCurveLength, 1, static_cast<int>(releaseCurve.size()));
+
+    curveEnvelope = 1.0f;
+    curveLength = 0;
+    curveEnded = false;
+    releaseCurveStale = false;
+}
+
+float GatedReverb::releaseGainAt(int position)
+{
+    if (builtGateCurve != GateCurve::Shaped)
+    {
+        // Preset curve stretched over the release time
+        if (position >= presetCurveLength)
+            return 0.0f;
+
+        const auto& points = curvePoints[static_cast<int>(builtGateCurve) - 1];
+        float scaled = static_cast<float>(position) / static_cast<float>(presetCurveLength) * (numCurvePoints - 1);
+        int index = std::min(static_cast<int>(scaled), numCurvePoints - 2);
+        float frac = scaled - static_cast<float>(index);
+        return points[index] + (points[index + 1] - points[index]) * frac;
+    }
+
+    // Linear ramp down, bent towards exponential by the shape, applied to
+    // the envelope each sample so the bend compounds over the release. Only
+    // the samples the release has reached are computed, and they are kept
+    // for the releases after it.
+    const int capacity = static_cast<int>(releaseCurve.size());
+    const float bend = 1.0f + curveGateShape * 3.0f;
+    while (curveLength < position && !curveEnded)
+    {
+        curveEnvelope = std::max(0.0f, curveEnvelope - curveReleaseCoeff);
+
+        if (curveGateShape > 0.0f)
+        {
+            float expEnv = std::pow(curveEnvelope, bend);
+            curveEnvelope = curveEnvelope * (1.0f - curveGateShape) + expEnv * curveGateShape;
+        }
+
+        if (curveEnvelope <= 0.001f)
+            curveEnded = true;
+        else
+            releaseCurve[curveLength++] = curveEnvelope;
+
+        if (curveLength == capacity)
+            curveEnded = true;
+    }
+
+    return position <= curveLength ? releaseCurve[position - 1] : 0.0f;
 }
 
 void GatedReverb::updateParameters()
 {
+    // Calculate lookahead
+    lookaheadTarget = static_cast<int>(lookaheadMs * currentSampleRate / 1000.0);
+    lookaheadTarget = std::clamp(lookaheadTarget, 0, static_cast<int>(lookaheadBufferL.size()) - 1);
+
     // Calculate pre-delay
     preDelaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0);
     preDelaySamples = std::clamp(preDelaySamples, 0, static_cast<int>(preDelayBufferL.size()) - 1);
 
     // Gate timing
     holdSamples = holdTimeMs * currentSampleRate / 1000.0f;
+    attackIncrement = 1.0f / std::max(1.0f, attackTimeMs * static_cast<float>(currentSampleRate) / 1000.0f);
     releaseCoeff = DSPUtils::calculateCoefficient(currentSampleRate, releaseTimeMs);
+    if (releaseCoeff != curveReleaseCoeff || gateShape != curveGateShape || gateCurve != builtGateCurve)
+        releaseCurveStale = true;
 
     // Setup early reflections (dense, even spacing for 80s character)
     int earlyBufSize = static_cast<int>(earlyBufferL.size()) - 1;
@@ -187,19 +280,84 @@ void GatedReverb::updateParameters()
     for (int i = 0; i < numDiffusers; ++i)
     {
         int delay = static_cast<int>(diffuserDelays[i] * size * currentSampleRate / 44100.0);
-        diffusersL[i].setDelay(std::clamp(delay, 1, 4095));
-        diffusersR[i].setDelay(std::clamp(static_cast<int>(delay * 1.1f), 1, 4095));
-        diffusersL[i].setFeedback(0.5f + diffusion * 0.3f);
-        diffusersR[i].setFeedback(0.5f + diffusion * 0.3f);
+        diffusers.setDelay(i, delay, static_cast<int>(delay * 1.1f));
     }
+    diffusers.setFeedback(0.5f + diffusion * 0.3f);
+    diffusers.setTopology(diffuserTopology);
 
     // Update filters
     auto hpCoeffs = DSPUtils::calcHighPass(currentSampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(currentSampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
+}
+
+float GatedReverb::advanceGate(bool keyAbove, bool keyOnset, int numSamples)
+{
+    // Freeze holds the gate where it is
+    if (freeze)
+        return gateEnvelope;
+
+    // Trigger: open a closed gate, or retrigger an open one
+    if (keyAbove && (gateStage == GateStage::Closed || retriggerMode != GateRetrigger::Ignore))
+    {
+        if (retriggerMode == GateRetrigger::Restart && keyOnset)
+            gateEnvelope = 0.0f;
+
+        gateStage = gateEnvelope < 1.0f ? GateStage::Attack : GateStage::Hold;
+        holdCounter = static_cast<int>(holdSamples);
+    }
+
+    // Run the stages over the step, handing leftover samples on to the next
+    int remaining = numSamples;
+    while (remaining > 0)
+    {
+        switch (gateStage)
+        {
+            case GateStage::Closed:
+                gateEnvelope = 0.0f;
+                remaining = 0;
+                break;
+
+            case GateStage::Attack:
+            {
+                int toOpen = static_cast<int>(std::ceil((1.0f - gateEnvelope) / attackIncrement));
+                int used = std::min(remaining, toOpen);
+                gateEnvelope = std::min(1.0f, gateEnvelope + attackIncrement * static_cast<float>(used));
+                remaining -= used;
+                if (gateEnvelope >= 1.0f)
+                    gateStage = GateStage::Hold;
+                break;
+            }
+
+            case GateStage::Hold:
+            {
+                int used = std::min(remaining, holdCounter);
+                holdCounter -= used;
+                remaining -= used;
+                if (holdCounter == 0)
+                {
+                    gateStage = GateStage::Release;
+                    releasePosition = 0;
+                    if (releaseCurveStale)
+                        startReleaseCurve();
+                }
+                break;
+            }
+
+            case GateStage::Release:
+                // Release always starts from fully open, so it just steps
+                // along the release curve
+                releasePosition += remaining;
+                remaining = 0;
+                gateEnvelope = releaseGainAt(releasePosition);
+                if (gateEnvelope <= 0.0f)
+                    gateStage = GateStage::Closed;
+                break;
+        }
+    }
+
+    return gateEnvelope;
 }
 
 void GatedReverb::processReverb(float inputL, float inputR, float& outL, float& outR)
@@ -248,17 +406,18 @@ void GatedReverb::processReverb(float inputL, float inputR, float& outL, float&
         }
     }
 
-    // Calculate feedback (relatively high for dense tail)
+    // Calculate feedback (relatively high for dense tail, lossless while frozen)
     float feedback = 0.85f + decaySeconds * 0.05f;
-    feedback = std::clamp(feedback, 0.0f, 0.95f);
+    feedback = freeze ? 1.0f : std::clamp(feedback, 0.0f, 0.95f);
+    const float loopDamping = freeze ? 0.0f : damping * 0.5f;
 
     // Write back with damping
     for (int i = 0; i < fdnSize; ++i)
     {
-        float dampedOutput = mixedOutputs[i] * (1.0f - damping * 0.5f) + fdnFilterStates[i] * damping * 0.5f;
+        float dampedOutput = mixedOutputs[i] * (1.0f - loopDamping) + fdnFilterStates[i] * loopDamping;
         fdnFilterStates[i] = dampedOutput;
 
-        float feedbackSample = dampedOutput * feedback;
+        float feedbackSample = loopEnergy.process(dampedOutput * feedback);
         // Inject early reflections into FDN
         float newSample = (i < 3) ?
             earlyL * 0.3f + feedbackSample :
@@ -285,114 +444,167 @@ void GatedReverb::process(juce::AudioBuffer<float>& buffer)
     if (bypassed)
         return;
 
-    updateParameters();
+    if (takeParameterChanges())
+        updateParameters();
 
     auto* leftChannel = buffer.getWritePointer(0);
     auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
+
+    // Gate key: the sidechain when one is set, otherwise the input itself
+    const float* keyLeft = sidechainL ? sidechainL : leftChannel;
+    const float* keyRight = sidechainL ? sidechainR : rightInput;
 
     int numSamples = buffer.getNumSamples();
     int preDelayBufSize = static_cast<int>(preDelayBufferL.size());
+    int lookaheadBufSize = static_cast<int>(lookaheadBufferL.size());
 
     float thresholdLinear = DSPUtils::decibelsToLinear(threshold);
 
-    for (int sample = 0; sample < numSamples; ++sample)
+    // Work in short slices so the diffusers can run a stage at a time
+    for (int start = 0; start < numSamples; start += diffusionBlockSize)
     {
-        float inputL = leftChannel[sample];
-        float inputR = rightChannel ? rightChannel[sample] : inputL;
-
-        // Envelope follower on input (for gate triggering)
-        float envL = inputEnvelopeL.process(inputL);
-        float envR = inputEnvelopeR.process(inputR);
-        float inputEnvelope = std::max(envL, envR);
-
-        // Gate logic
-        if (inputEnvelope > thresholdLinear)
+        const int sliceSize = std::min(diffusionBlockSize, numSamples - start);
+        float* sliceL = leftChannel + start;
+        float* sliceR = rightChannel ? rightChannel + start : nullptr;
+        const float* sliceRightInput = rightInput ? rightInput + start : nullptr;
+        const float* sliceKeyL = keyLeft + start;
+        const float* sliceKeyR = keyRight ? keyRight + start : nullptr;
+
+        // A new lookahead moves the read head with a crossfade from the old
+        // one, once any crossfade already running has finished. After a
+        // reset there is nothing to fade from, so it jumps.
+        if (snapLookahead)
         {
-            gateOpen = true;
-            holdCounter = static_cast<int>(holdSamples);
-            gateEnvelope = 1.0f;
+            lookaheadSamples = lookaheadTarget;
+            snapLookahead = false;
         }
-        else if (holdCounter > 0)
+        else if (lookaheadFade >= 1.0f && lookaheadTarget != lookaheadSamples)
         {
-            holdCounter--;
+            lookaheadFadeFrom = lookaheadSamples;
+            lookaheadSamples = lookaheadTarget;
+            lookaheadFade = 0.0f;
         }
-        else if (gateOpen)
+
+        // Lookahead, input filtering and pre-delay
+        for (int sample = 0; sample < sliceSize; ++sample)
         {
-            // Release phase
-            gateEnvelope -= releaseCoeff;
+            lookaheadBufferL[lookaheadWriteIndex] = sliceL[sample];
+            if (sliceRightInput)
+                lookaheadBufferR[lookaheadWriteIndex] = sliceRightInput[sample];
 
-            // Apply shape (0 = linear, 1 = exponential)
-            float shapedEnvelope = gateEnvelope;
-            if (gateShape > 0.0f)
-            {
-                // Interpolate between linear and exponential
-                float expEnv = std::pow(gateEnvelope, 1.0f + gateShape * 3.0f);
-                shapedEnvelope = gateEnvelope * (1.0f - gateShape) + expEnv * gateShape;
-            }
+            int lookaheadReadIndex = lookaheadWriteIndex - lookaheadSamples;
+            if (lookaheadReadIndex < 0) lookaheadReadIndex += lookaheadBufSize;
 
-            gateEnvelope = shapedEnvelope;
+            float inputL = lookaheadBufferL[lookaheadReadIndex];
+            float inputR = sliceRightInput ? lookaheadBufferR[lookaheadReadIndex] : inputL;
 
-            if (gateEnvelope <= 0.001f)
+            if (lookaheadFade < 1.0f)
             {
-                gateEnvelope = 0.0f;
-                gateOpen = false;
+                int fadeFromIndex = lookaheadWriteIndex - lookaheadFadeFrom;
+                if (fadeFromIndex < 0) fadeFromIndex += lookaheadBufSize;
+
+                float previousL = lookaheadBufferL[fadeFromIndex];
+                float previousR = sliceRightInput ? lookaheadBufferR[fadeFromIndex] : previousL;
+                inputL = previousL + (inputL - previousL) * lookaheadFade;
+                inputR = previousR + (inputR - previousR) * lookaheadFade;
+                lookaheadFade = std::min(1.0f, lookaheadFade + lookaheadFadeStep);
             }
-        }
 
-        currentGateLevel.store(gateEnvelope);
+            lookaheadWriteIndex++;
+            if (lookaheadWriteIndex >= lookaheadBufSize) lookaheadWriteIndex = 0;
 
-        // Input filtering
-        float filteredL = highPassL.process(inputL);
-        float filteredR = highPassR.process(inputR);
+            // Input filtering, once for a mono source
+            if (sliceRightInput)
+                highPass.process(inputL, inputR);
+            else
+                inputL = highPass.processMono(inputL);
 
-        // Pre-delay
-        preDelayBufferL[preDelayWriteIndex] = filteredL;
-        preDelayBufferR[preDelayWriteIndex] = filteredR;
+            // Pre-delay
+            preDelayBufferL[preDelayWriteIndex] = inputL;
+            if (sliceRightInput)
+                preDelayBufferR[preDelayWriteIndex] = inputR;
 
-        int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
-        if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
+            int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
+            if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
 
-        float delayedL = preDelayBufferL[preDelayReadIndex];
-        float delayedR = preDelayBufferR[preDelayReadIndex];
+            // A mono source splits into left and right at the diffusers
+            diffusionL[sample] = preDelayBufferL[preDelayReadIndex];
+            diffusionR[sample] = sliceRightInput ? preDelayBufferR[preDelayReadIndex] : diffusionL[sample];
 
-        preDelayWriteIndex++;
-        if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+            preDelayWriteIndex++;
+            if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+        }
 
         // Diffusion
-        for (int i = 0; i < numDiffusers; ++i)
+        diffusers.processBlock(diffusionL.data(), diffusionR.data(), sliceSize);
+
+        // Gate envelope. The key is followed per sample, the stages advance
+        // once per envelope step and the gain ramps linearly across it.
+        for (int stepStart = 0; stepStart < sliceSize; stepStart += envelopeStep)
         {
-            delayedL = diffusersL[i].process(delayedL);
-            delayedR = diffusersR[i].process(delayedR);
+            const int stepSize = std::min(envelopeStep, sliceSize - stepStart);
+
+            // Envelope follower on the key (for gate triggering). It sees the
+            // key ahead of the delayed audio path.
+            bool keyAbove = false;
+            bool keyOnset = false;
+            for (int sample = stepStart; sample < stepStart + stepSize; ++sample)
+            {
+                float inputEnvelope = inputEnvelopeL.process(sliceKeyL[sample]);
+                if (sliceKeyR)
+                    inputEnvelope = std::max(inputEnvelope, inputEnvelopeR.process(sliceKeyR[sample]));
+
+                const bool above = inputEnvelope > thresholdLinear;
+                keyOnset = keyOnset || (above && !keyWasAbove);
+                keyAbove = keyAbove || above;
+                keyWasAbove = above;
+            }
+
+            const float startLevel = gateEnvelope;
+            const float endLevel = advanceGate(keyAbove, keyOnset, stepSize);
+            const float increment = (endLevel - startLevel) / static_cast<float>(stepSize);
+            for (int i = 0; i < stepSize; ++i)
+                gateGains[stepStart + i] = startLevel + increment * static_cast<float>(i + 1);
         }
 
         // Process reverb
-        float reverbL, reverbR;
-        processReverb(delayedL, delayedR, reverbL, reverbR);
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            // Input into the reverb fades out while frozen
+            float tankInputGain = loopEnergy.getNextInputGain();
+            float delayedL = diffusionL[sample] * tankInputGain;
+            float delayedR = diffusionR[sample] * tankInputGain;
+
+            processReverb(delayedL, delayedR, reverbL[sample], reverbR[sample]);
+        }
 
         // Apply gate envelope
-        reverbL *= gateEnvelope;
-        reverbR *= gateEnvelope;
-
-        // Mid boost for 80s character
-        reverbL = midBoostL.process(reverbL);
-        reverbR = midBoostR.process(reverbR);
-
-        // Output filtering
-        reverbL = lowPassL.process(reverbL);
-        reverbR = lowPassR.process(reverbR);
-
-        // Apply width
-        float mid = (reverbL + reverbR) * 0.5f;
-        float side = (reverbL - reverbR) * 0.5f;
-        float wetL = mid + side * width;
-        float wetR = mid - side * width;
-
-        // Mix
-        float dryL = leftChannel[sample];
-        float dryR = rightChannel ? rightChannel[sample] : dryL;
-
-        leftChannel[sample] = dryL * (1.0f - mix) + wetL * mix;
-        if (rightChannel)
-            rightChannel[sample] = dryR * (1.0f - mix) + wetR * mix;
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            reverbL[sample] *= gateGains[sample];
+            reverbR[sample] *= gateGains[sample];
+        }
+
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float wetL = reverbL[sample];
+            float wetR = reverbR[sample];
+
+            // Mid boost for 80s character
+            midBoost.process(wetL, wetR);
+
+            // Output filtering
+            lowPass.process(wetL, wetR);
+
+            sliceL[sample] = wetL;
+            if (sliceR)
+                sliceR[sample] = wetR;
+        }
     }
+
+    // Meter update, once per block
+    currentGateLevel.store(gateEnvelope, std::memory_order_relaxed);
+
+    loopEnergy.endBlock();
 }
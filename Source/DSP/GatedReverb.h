@@ -5,44 +5,94 @@
 #include "DSPUtils.h"
 #include <array>
 
+// Release curve of the gate envelope
+enum class GateCurve
+{
+    Shaped = 0,   // Linear to exponential, bent by the gate shape
+    Linear,
+    Exponential,
+    Nonlinear     // Stays nearly flat, then drops at the end
+};
+
+// What a new trigger does while the gate is already open
+enum class GateRetrigger
+{
+    Legato = 0,   // Ramps up from the current level and restarts the hold
+    Restart,      // Drops to silence and runs the attack again
+    Ignore        // The envelope runs its full course once opened
+};
+
 class GatedReverb : public ReverbBase
 {
 public:
-    GatedReverb();
-
     void prepare(double sampleRate, int samplesPerBlock) override;
     void process(juce::AudioBuffer<float>& buffer) override;
     void reset() override;
 
     // Gate-specific parameters
     void setThreshold(float thresholdDb);    // -60 to 0 dB
+    void setAttackTime(float attackMs);      // 0-500ms, long attacks give reverse swells
     void setHoldTime(float holdMs);          // 10-500ms
     void setReleaseTime(float releaseMs);    // 10-500ms
     void setGateShape(float shape);          // 0-1, affects envelope shape
+    void setLookahead(float lookaheadMs);    // 0-10ms, delays the audio behind the detector
+    void setReleaseCurve(GateCurve curve);
+    void setRetriggerMode(GateRetrigger mode);
 
     float getThreshold() const { return threshold; }
+    float getAttackTime() const { return attackTimeMs; }
     float getHoldTime() const { return holdTimeMs; }
     float getReleaseTime() const { return releaseTimeMs; }
     float getGateShape() const { return gateShape; }
+    float getLookahead() const { return lookaheadMs; }
+    GateCurve getReleaseCurve() const { return gateCurve; }
+    GateRetrigger getRetriggerMode() const { return retriggerMode; }
+
+    // Output delay added by the lookahead, for the host's latency compensation
+    int getLatencySamples() const { return lookaheadTarget; }
+
+    // External key for the gate detector, read by the next process() call.
+    // keyRight may be nullptr for a mono key; keyLeft nullptr keys the gate
+    // from the reverb's own input.
+    void setSidechain(const float* keyLeft, const float* keyRight)
+    {
+        sidechainL = keyLeft;
+        sidechainR = keyRight;
+    }
 
     // Get current gate state for visualization
-    float getGateLevel() const { return currentGateLevel.load(); }
+    float getGateLevel() const { return currentGateLevel.load(std::memory_order_relaxed); }
 
 private:
     void updateParameters();
+    void startReleaseCurve();
+    float releaseGainAt(int position);
+    float advanceGate(bool keyAbove, bool keyOnset, int numSamples);
     void processReverb(float inputL, float inputR, float& outL, float& outR);
 
     // Gate parameters
     float threshold = -30.0f;      // dB
+    float attackTimeMs = 0.0f;     // ms
     float holdTimeMs = 100.0f;     // ms
     float releaseTimeMs = 100.0f;  // ms
     float gateShape = 0.5f;        // Linear to exponential
-
-    // Gate state
+    float lookaheadMs = 0.0f;      // ms
+    GateCurve gateCurve = GateCurve::Shaped;
+    GateRetrigger retriggerMode = GateRetrigger::Legato;
+
+    // Gate state. The envelope is a chain of stages advanced once per
+    // envelope step; gateEnvelope is its level at the end of the last step.
+    enum class GateStage { Closed, Attack, Hold, Release };
+    GateStage gateStage = GateStage::Closed;
     float gateEnvelope = 0.0f;
     int holdCounter = 0;
-    bool gateOpen = false;
-    std::atomic<float> currentGateLevel { 0.0f };
+    int releasePosition = 0;
+    bool keyWasAbove = false;
+    std::atomic<float> currentGateLevel { 0.0f };  // Updated once per block
+
+    // External gate key, nullptr when keyed from the input
+    const float* sidechainL = nullptr;
+    const float* sidechainR = nullptr;
 
     // Envelope follower for input
     DSPUtils::EnvelopeFollower inputEnvelopeL;
@@ -50,8 +100,51 @@ private:
 
     // Coefficients
     float holdSamples = 0;
+    float attackIncrement = 1.0f;  // Per sample
     float releaseCoeff = 0.0f;
 
+    // The stages are evaluated every envelope step and the gain ramps
+    // linearly between the step ends
+    static constexpr int envelopeStep = 16;
+
+    // Release envelope, one value per sample from the end of the hold until
+    // the gate closes. Release always starts from fully open, so the curve
+    // depends only on its settings. The Shaped curve is filled in as releases
+    // reach it and reused after that; a change of release time, shape, curve
+    // or sample rate marks it stale and it restarts with the next release.
+    std::vector<float> releaseCurve;
+    int curveLength = 0;
+    bool curveEnded = false;
+    float curveEnvelope = 1.0f;
+    bool releaseCurveStale = true;
+    int presetCurveLength = 1;
+    float curveReleaseCoeff = -1.0f;
+    float curveGateShape = -1.0f;
+    GateCurve builtGateCurve = GateCurve::Shaped;
+
+    // Breakpoints of the preset curves: gain at evenly spaced points across
+    // the release, interpolated linearly between them
+    static constexpr int numCurvePoints = 9;
+    static constexpr float curvePoints[3][numCurvePoints] = {
+        { 1.0f, 0.875f, 0.75f, 0.625f, 0.5f, 0.375f, 0.25f, 0.125f, 0.0f },   // Linear
+        { 1.0f, 0.54f, 0.29f, 0.155f, 0.082f, 0.043f, 0.021f, 0.009f, 0.0f }, // Exponential
+        { 1.0f, 0.98f, 0.96f, 0.94f, 0.92f, 0.9f, 0.87f, 0.8f, 0.0f }         // Nonlinear
+    };
+
+    // Lookahead: the gate detector reads the input as it arrives while the
+    // reverb path runs this far behind it (the processor delays the dry path
+    // to match). A change of lookahead crossfades from the old read head to
+    // the new one instead of jumping.
+    std::vector<float> lookaheadBufferL;
+    std::vector<float> lookaheadBufferR;
+    int lookaheadWriteIndex = 0;
+    int lookaheadTarget = 0;     // From the parameter, and the reported latency
+    int lookaheadSamples = 0;    // Read head in use
+    int lookaheadFadeFrom = 0;   // Old read head during a crossfade
+    float lookaheadFade = 1.0f;  // 0-1, 1 when no crossfade is running
+    float lookaheadFadeStep = 1.0f;
+    bool snapLookahead = true;   // Jump straight to the target after a reset
+
     // Pre-delay
     std::vector<float> preDelayBufferL;
     std::vector<float> preDelayBufferR;
@@ -77,15 +170,22 @@ private:
 
     // Diffusers
     static constexpr int numDiffusers = 4;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersL;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersR;
+    DSPUtils::DiffuserBank diffusers;
+
+    // Diffusion runs on slices of this many samples, a stage at a time
+    static constexpr int diffusionBlockSize = 64;
+    std::array<float, diffusionBlockSize> diffusionL {};
+    std::array<float, diffusionBlockSize> diffusionR {};
+    std::array<float, diffusionBlockSize> gateGains {};
+    std::array<float, diffusionBlockSize> reverbL {};
+    std::array<float, diffusionBlockSize> reverbR {};
 
     // Filters
-    DSPUtils::BiquadFilter highPassL, highPassR;
-    DSPUtils::BiquadFilter lowPassL, lowPassR;
+    DSPUtils::StereoBiquad highPass;
+    DSPUtils::StereoBiquad lowPass;
 
     // Additional mid-frequency boost for 80s character
-    DSPUtils::BiquadFilter midBoostL, midBoostR;
+    DSPUtils::StereoBiquad midBoost;
 
     // Householder mixing matrix for 6x6 FDN
     static constexpr float householder[6][6] = {
@@ -0,0 +1,267 @@
+#include "PlateReverb.h"
+#include <cmath>
+
+namespace
+{
+    // Output taps from Dattorro's table, in reference samples. Each output
+    // mostly taps the opposite half, the remaining taps are subtracted.
+    const int leftTapAges[7] = { 266, 2974, 1913, 1996, 1990, 187, 1066 };
+    const int rightTapAges[7] = { 353, 3627, 1228, 2673, 2111, 335, 121 };
+    constexpr float tapGain = 0.6f;
+}
+
+void PlateReverb::prepare(double sampleRate, int samplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
+
+    // Allocate pre-delay buffer (up to 500ms)
+    int maxPreDelaySamples = static_cast<int>(sampleRate * 0.5);
+    preDelayBuffer.resize(maxPreDelaySamples, 0.0f);
+
+    // Size every line for the largest size setting at this rate
+    const float maxScale = maxSizeScale * static_cast<float>(sampleRate) / referenceRate;
+    const int maxModulation = static_cast<int>(std::ceil(maxExcursion * sampleRate / referenceRate)) + 2;
+
+    for (int i = 0; i < 4; ++i)
+        inputDiffusers[i].prepare(static_cast<int>(std::ceil(inputDiffuserDelays[i] * sampleRate / referenceRate)) + 1,
+                                  blockSize);
+
+    for (int side = 0; side < 2; ++side)
+    {
+        tankAllpass1[side].prepare(static_cast<int>(std::ceil(tankAllpass1Delays[side] * maxScale)) + maxModulation,
+                                   blockSize);
+        tankDelay1[side].prepare(static_cast<int>(std::ceil(tankDelay1Delays[side] * maxScale)) + 1, blockSize);
+        tankAllpass2[side].prepare(static_cast<int>(std::ceil(tankAllpass2Delays[side] * maxScale)) + 1, blockSize);
+        tankDelay2[side].prepare(static_cast<int>(std::ceil(tankDelay2Delays[side] * maxScale)) + 1, blockSize);
+    }
+
+    // Setup filters
+    highPass.setCoefficients(DSPUtils::calcHighPass(sampleRate, highPassFreq));
+    lowPass.setCoefficients(DSPUtils::calcLowPass(sampleRate, lowPassFreq));
+
+    loopEnergy.prepare(sampleRate);
+
+    updateParameters();
+    reset();
+}
+
+void PlateReverb::reset()
+{
+    std::fill(preDelayBuffer.begin(), preDelayBuffer.end(), 0.0f);
+    preDelayWriteIndex = 0;
+
+    for (auto& diffuser : inputDiffusers)
+        diffuser.reset();
+
+    for (int side = 0; side < 2; ++side)
+    {
+        tankAllpass1[side].reset();
+        tankDelay1[side].reset();
+        tankAllpass2[side].reset();
+        tankDelay2[side].reset();
+    }
+    dampingStates.fill(0.0f);
+
+    highPass.reset();
+    lowPass.reset();
+
+    loopEnergy.reset();
+    lfoCos = 1.0f;
+    lfoSin = 0.0f;
+}
+
+void PlateReverb::updateParameters()
+{
+    const float sampleRate = static_cast<float>(currentSampleRate);
+    const float rateScale = sampleRate / referenceRate;
+
+    // Calculate pre-delay in samples
+    preDelaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0);
+    preDelaySamples = std::clamp(preDelaySamples, 0, static_cast<int>(preDelayBuffer.size()) - 1);
+
+    // Input diffusion: Dattorro's 0.75 / 0.625 at the default diffusion
+    float diffusionScale = diffusion / 0.7f;
+    for (int i = 0; i < 4; ++i)
+    {
+        inputDiffusers[i].setDelay(static_cast<int>(inputDiffuserDelays[i] * rateScale));
+        inputDiffusers[i].setFeedback(std::min((i < 2 ? 0.75f : 0.625f) * diffusionScale, 0.9f));
+    }
+
+    // Tank lengths follow size
+    const float scale = (0.5f + size) * rateScale;
+    float loopLength = 0.0f;
+    for (int side = 0; side < 2; ++side)
+    {
+        tankAllpass1[side].setDelay(static_cast<int>(tankAllpass1Delays[side] * scale));
+        tankDelay1[side].setDelay(static_cast<int>(tankDelay1Delays[side] * scale));
+        tankAllpass2[side].setDelay(static_cast<int>(tankAllpass2Delays[side] * scale));
+        tankDelay2[side].setDelay(static_cast<int>(tankDelay2Delays[side] * scale));
+        loopLength += (tankAllpass1Delays[side] + tankDelay1Delays[side] +
+                       tankAllpass2Delays[side] + tankDelay2Delays[side]) * scale;
+    }
+
+    for (int i = 0; i < 7; ++i)
+    {
+        leftTaps[i] = static_cast<int>(leftTapAges[i] * scale);
+        rightTaps[i] = static_cast<int>(rightTapAges[i] * scale);
+    }
+
+    // A full trip round the figure eight passes four decay gains
+    if (freeze)
+        decayGain = 1.0f;  // Lossless loop, level held by loopEnergy
+    else
+        decayGain = std::clamp(std::pow(10.0f, -3.0f * loopLength / (4.0f * decaySeconds * sampleRate)), 0.0f, 0.99f);
+
+    // Decay diffusion: Dattorro's 0.7 on the modulated allpasses, and the
+    // second allpass following decay so long tails stay dense
+    for (int side = 0; side < 2; ++side)
+    {
+        tankAllpass1[side].setFeedback(-0.7f);
+        tankAllpass2[side].setFeedback(std::clamp(decayGain + 0.15f, 0.25f, 0.5f));
+    }
+
+    // Damping pole, matched to the reference rate. Frozen, the loop stays
+    // lossless, so the damping is off and the held tail keeps its colour.
+    dampingPole = freeze ? 0.0f : std::pow(damping * 0.7f, referenceRate / sampleRate);
+
+    excursion = modDepth * maxExcursion * rateScale;
+    float w = 2.0f * 3.14159265358979323846f * modRate / sampleRate;
+    lfoStepCos = std::cos(w);
+    lfoStepSin = std::sin(w);
+
+    // Update filters
+    highPass.setCoefficients(DSPUtils::calcHighPass(currentSampleRate, highPassFreq));
+    lowPass.setCoefficients(DSPUtils::calcLowPass(currentSampleRate, lowPassFreq));
+}
+
+void PlateReverb::processTank(int numSamples)
+{
+    // Each half is driven by the end of the other half's loop
+    tankDelay2[1].peek(halves[0].data(), numSamples);
+    tankDelay2[0].peek(halves[1].data(), numSamples);
+    for (int side = 0; side < 2; ++side)
+        for (int n = 0; n < numSamples; ++n)
+            halves[side][n] = tankInput[n] + loopEnergy.process(halves[side][n] * decayGain);
+
+    // Modulation, left on the sine and right on the cosine
+    float c = lfoCos;
+    float s = lfoSin;
+    for (int n = 0; n < numSamples; ++n)
+    {
+        float nextC = c * lfoStepCos - s * lfoStepSin;
+        s = s * lfoStepCos + c * lfoStepSin;
+        c = nextC;
+        modulation[0][n] = excursion * s;
+        modulation[1][n] = excursion * c;
+    }
+
+    // Keep the phasor on the unit circle
+    float norm = 1.5f - 0.5f * (c * c + s * s);
+    lfoCos = c * norm;
+    lfoSin = s * norm;
+
+    for (int side = 0; side < 2; ++side)
+    {
+        float* half = halves[side].data();
+
+        tankAllpass1[side].processModulated(half, modulation[side].data(), numSamples);
+        tankDelay1[side].process(half, numSamples);
+
+        // Damping
+        float state = dampingStates[side];
+        for (int n = 0; n < numSamples; ++n)
+        {
+            state = half[n] * (1.0f - dampingPole) + state * dampingPole;
+            half[n] = state * decayGain;
+        }
+        dampingStates[side] = state;
+
+        tankAllpass2[side].process(half, numSamples);
+        tankDelay2[side].write(half, numSamples);
+    }
+
+    // Output taps
+    std::fill(wetL.begin(), wetL.begin() + numSamples, 0.0f);
+    std::fill(wetR.begin(), wetR.begin() + numSamples, 0.0f);
+
+    tankDelay1[1].addTap(wetL.data(), numSamples, leftTaps[0], tapGain);
+    tankDelay1[1].addTap(wetL.data(), numSamples, leftTaps[1], tapGain);
+    tankAllpass2[1].addTap(wetL.data(), numSamples, leftTaps[2], -tapGain);
+    tankDelay2[1].addTap(wetL.data(), numSamples, leftTaps[3], tapGain);
+    tankDelay1[0].addTap(wetL.data(), numSamples, leftTaps[4], -tapGain);
+    tankAllpass2[0].addTap(wetL.data(), numSamples, leftTaps[5], -tapGain);
+    tankDelay2[0].addTap(wetL.data(), numSamples, leftTaps[6], -tapGain);
+
+    tankDelay1[0].addTap(wetR.data(), numSamples, rightTaps[0], tapGain);
+    tankDelay1[0].addTap(wetR.data(), numSamples, rightTaps[1], tapGain);
+    tankAllpass2[0].addTap(wetR.data(), numSamples, rightTaps[2], -tapGain);
+    tankDelay2[0].addTap(wetR.data(), numSamples, rightTaps[3], tapGain);
+    tankDelay1[1].addTap(wetR.data(), numSamples, rightTaps[4], -tapGain);
+    tankAllpass2[1].addTap(wetR.data(), numSamples, rightTaps[5], -tapGain);
+    tankDelay2[1].addTap(wetR.data(), numSamples, rightTaps[6], -tapGain);
+}
+
+void PlateReverb::process(juce::AudioBuffer<float>& buffer)
+{
+    if (bypassed)
+        return;
+
+    if (takeParameterChanges())
+        updateParameters();
+
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
+
+    int numSamples = buffer.getNumSamples();
+    int preDelayBufSize = static_cast<int>(preDelayBuffer.size());
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        const int sliceSize = std::min(blockSize, numSamples - start);
+        float* sliceL = leftChannel + start;
+        float* sliceR = rightChannel ? rightChannel + start : nullptr;
+        const float* sliceRightInput = rightInput ? rightInput + start : nullptr;
+
+        // Mono sum, input filtering and pre-delay
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float input = sliceRightInput ? (sliceL[sample] + sliceRightInput[sample]) * 0.5f : sliceL[sample];
+
+            preDelayBuffer[preDelayWriteIndex] = highPass.process(input);
+
+            int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
+            if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
+            tankInput[sample] = preDelayBuffer[preDelayReadIndex];
+
+            preDelayWriteIndex++;
+            if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+        }
+
+        // Input diffusion
+        for (auto& diffuser : inputDiffusers)
+            diffuser.process(tankInput.data(), sliceSize);
+
+        // Input into the tank fades out while frozen
+        for (int sample = 0; sample < sliceSize; ++sample)
+            tankInput[sample] *= loopEnergy.getNextInputGain();
+
+        processTank(sliceSize);
+
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float reverbL = wetL[sample];
+            float reverbR = wetR[sample];
+
+            // Output filtering
+            lowPass.process(reverbL, reverbR);
+
+            sliceL[sample] = reverbL;
+            if (sliceR)
+                sliceR[sample] = reverbR;
+        }
+    }
+
+    loopEnergy.endBlock();
+}
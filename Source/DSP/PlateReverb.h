@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReverbBase.h"
+#include "DSPUtils.h"
+#include <array>
+
+// Dattorro-style plate: mono input diffusion into a figure-eight tank of two
+// cross-fed halves, each a modulated allpass, delay, damping, allpass and
+// delay. The stereo output is built from taps all over the tank rather than
+// the ends of the loop, which gives the plate its dense, even build-up.
+// Twelve delay lines and no mixing matrix make it cheaper per sample than
+// the 8-line FDN in AlgorithmicReverb.
+//
+// The input diffusers are part of the topology, so the diffuser type does
+// not apply, and there are no separate early reflections.
+class PlateReverb : public ReverbBase
+{
+public:
+    void prepare(double sampleRate, int samplesPerBlock) override;
+    void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+
+private:
+    void updateParameters();
+    void processTank(int numSamples);
+
+    // Delay lengths from Dattorro's figure, at his 29761 Hz
+    static constexpr float referenceRate = 29761.0f;
+    static constexpr int inputDiffuserDelays[4] = { 142, 107, 379, 277 };
+    static constexpr int tankAllpass1Delays[2] = { 672, 908 };
+    static constexpr int tankDelay1Delays[2] = { 4453, 4217 };
+    static constexpr int tankAllpass2Delays[2] = { 1800, 2656 };
+    static constexpr int tankDelay2Delays[2] = { 3720, 3163 };
+    static constexpr float maxExcursion = 16.0f;  // Modulation at full depth, reference samples
+    static constexpr float maxSizeScale = 1.5f;
+
+    // The tank runs on slices of this many samples, a stage at a time. Each
+    // half reads the other half's last delay for the whole slice up front,
+    // which works because that delay is always longer than a slice.
+    static constexpr int blockSize = 64;
+
+    // Pre-delay (the tank input is mono)
+    std::vector<float> preDelayBuffer;
+    int preDelayWriteIndex = 0;
+    int preDelaySamples = 0;
+
+    // Input diffusion
+    std::array<DSPUtils::BlockAllpass, 4> inputDiffusers;
+
+    // Tank, [0] = left half, [1] = right half
+    std::array<DSPUtils::BlockAllpass, 2> tankAllpass1;  // Modulated
+    std::array<DSPUtils::BlockDelay, 2> tankDelay1;
+    std::array<DSPUtils::BlockAllpass, 2> tankAllpass2;
+    std::array<DSPUtils::BlockDelay, 2> tankDelay2;
+    std::array<float, 2> dampingStates {};
+
+    float decayGain = 0.5f;
+    float dampingPole = 0.0f;
+    float excursion = 0.0f;
+
+    // Output taps, scaled to the current size and rate
+    std::array<int, 7> leftTaps {};
+    std::array<int, 7> rightTaps {};
+
+    // Quadrature LFO for the two modulated allpasses
+    float lfoCos = 1.0f;
+    float lfoSin = 0.0f;
+    float lfoStepCos = 1.0f;
+    float lfoStepSin = 0.0f;
+
+    // Slice buffers
+    std::array<float, blockSize> tankInput {};
+    std::array<std::array<float, blockSize>, 2> halves {};
+    std::array<std::array<float, blockSize>, 2> modulation {};
+    std::array<float, blockSize> wetL {};
+    std::array<float, blockSize> wetR {};
+
+    // Filters
+    DSPUtils::BiquadFilter highPass;
+    DSPUtils::StereoBiquad lowPass;
+};
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DSPUtils.h"
 
-// Base class for all reverb types
+// Base class for all reverb types. process() replaces the input with the
+// 100% wet signal; the processor mixes it with the dry signal, ducks it and
+// sets its width.
 class ReverbBase
 {
 public:
@@ -13,28 +16,62 @@ public:
     virtual void reset() = 0;
 
     // Common parameters all reverbs share
-    void setPreDelay(float preDelayMs) { this->preDelayMs = preDelayMs; }
-    void setDecay(float decaySeconds) { this->decaySeconds = decaySeconds; }
-    void setDamping(float dampingAmount) { this->damping = dampingAmount; }
-    void setSize(float roomSize) { this->size = roomSize; }
-    void setDiffusion(float diffusionAmount) { this->diffusion = diffusionAmount; }
-    void setModRate(float rate) { this->modRate = rate; }
-    void setModDepth(float depth) { this->modDepth = depth; }
-    void setEarlyLevel(float level) { this->earlyLevel = level; }
-    void setWidth(float stereoWidth) { this->width = stereoWidth; }
-    void setHighPassFreq(float freq) { this->highPassFreq = freq; }
-    void setLowPassFreq(float freq) { this->lowPassFreq = freq; }
-    void setMix(float wetDryMix) { this->mix = wetDryMix; }
-    void setFreeze(bool frozen) { this->freeze = frozen; }
+    void setPreDelay(float preDelayMs) { setParameter(this->preDelayMs, preDelayMs); }
+    void setDecay(float decaySeconds) { setParameter(this->decaySeconds, decaySeconds); }
+    void setDamping(float dampingAmount) { setParameter(damping, dampingAmount); }
+    void setSize(float roomSize) { setParameter(size, roomSize); }
+    void setDiffusion(float diffusionAmount) { setParameter(diffusion, diffusionAmount); }
+    void setModRate(float rate) { setParameter(modRate, rate); }
+    void setModDepth(float depth) { setParameter(modDepth, depth); }
+    void setEarlyLevel(float level) { setParameter(earlyLevel, level); }
+    void setHighPassFreq(float freq) { setParameter(highPassFreq, freq); }
+    void setLowPassFreq(float freq) { setParameter(lowPassFreq, freq); }
+    void setDiffuserTopology(DSPUtils::DiffuserTopology topology) { setParameter(diffuserTopology, topology); }
+    void setFreeze(bool frozen)
+    {
+        setParameter(freeze, frozen);
+        loopEnergy.setFrozen(holdsTail());
+    }
     void setBypass(bool shouldBypass) { bypassed = shouldBypass; }
 
+    // Mono source (mono-in/mono-out or mono-in/stereo-out): the input chain
+    // runs once and only splits into left and right where the tank
+    // decorrelates them. Channel 1 of the buffer is then output only.
+    void setMonoInput(bool isMono) { monoInput = isMono; }
+
     bool isBypassed() const { return bypassed; }
     bool isFrozen() const { return freeze; }
 
+    // True while the tank is a lossless loop whose level is held by loopEnergy.
+    // Engines with their own sustain modes extend this.
+    virtual bool holdsTail() const { return freeze; }
+
 protected:
+    // Setters mark the parameters dirty when a value actually changes, and
+    // process() only recomputes the derived coefficients when it is set
+    template <typename T>
+    void setParameter(T& parameter, T value)
+    {
+        if (parameter != value)
+        {
+            parameter = value;
+            parametersDirty = true;
+        }
+    }
+
+    bool takeParameterChanges()
+    {
+        const bool changed = parametersDirty;
+        parametersDirty = false;
+        return changed;
+    }
+
+    bool parametersDirty = true;
+
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
     bool bypassed = false;
+    bool monoInput = false;
 
     // Common reverb parameters
     float preDelayMs = 0.0f;
@@ -45,9 +82,11 @@ protected:
     float modRate = 0.5f;
     float modDepth = 0.3f;
     float earlyLevel = 0.5f;
-    float width = 1.0f;
     float highPassFreq = 20.0f;
     float lowPassFreq = 20000.0f;
-    float mix = 0.5f;
     bool freeze = false;
+    DSPUtils::DiffuserTopology diffuserTopology = DSPUtils::DiffuserTopology::Classic;
+
+    // Freeze input fade, energy hold and safety limiting for the feedback network
+    DSPUtils::LoopEnergyControl loopEnergy;
 };
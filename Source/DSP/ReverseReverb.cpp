@@ -0,0 +1,224 @@
+#include "ReverseReverb.h"
+#include <cmath>
+
+ReverseReverb::ReverseReverb()
+{
+    // Fixed jitter, so the tap pattern is the same on every run
+    DSPUtils::FastNoise noise(0x5bd1e995u);
+    for (int i = 0; i < numTaps; ++i)
+    {
+        jitterL[i] = 0.4f * noise.nextBipolar();
+        jitterR[i] = 0.4f * noise.nextBipolar();
+    }
+}
+
+void ReverseReverb::prepare(double sampleRate, int samplesPerBlock)
+{
+    currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
+
+    // Diffuser arena, sized for the longest stage at full size
+    int maxDiffuserDelay = static_cast<int>(std::ceil(503 * 1.1f * sampleRate / 44100.0)) + 1;
+    diffusers.prepare(numDiffusers, maxDiffuserDelay, sampleRate);
+
+    // Rings for the longest reverse plus up to 500ms of pre-delay
+    int maxReverseSamples = static_cast<int>(std::ceil(maxReverseMs * sampleRate / 1000.0));
+    int maxPreDelaySamples = static_cast<int>(sampleRate * 0.5);
+    ringL.prepare(maxReverseSamples + maxPreDelaySamples + 1, blockSize);
+    ringR.prepare(maxReverseSamples + maxPreDelaySamples + 1, blockSize);
+
+    // Setup filters
+    highPass.setCoefficients(DSPUtils::calcHighPass(sampleRate, highPassFreq));
+    lowPass.setCoefficients(DSPUtils::calcLowPass(sampleRate, lowPassFreq));
+
+    // The dark taps roll off above ~1.5kHz
+    darkPole = std::exp(-2.0f * 3.14159265358979323846f * 1500.0f / static_cast<float>(sampleRate));
+
+    loopEnergy.prepare(sampleRate);
+
+    updateParameters();
+    reset();
+}
+
+void ReverseReverb::reset()
+{
+    ringL.reset();
+    ringR.reset();
+
+    diffusers.reset();
+
+    highPass.reset();
+    lowPass.reset();
+
+    darkStateL = 0.0f;
+    darkStateR = 0.0f;
+
+    loopEnergy.reset();
+}
+
+void ReverseReverb::setReverseLength(float lengthMs)
+{
+    reverseLengthMs = std::clamp(lengthMs, 50.0f, maxReverseMs);
+    updateParameters();
+}
+
+void ReverseReverb::setRise(float riseAmount)
+{
+    setParameter(rise, std::clamp(riseAmount, 0.0f, 1.0f));
+}
+
+void ReverseReverb::updateParameters()
+{
+    const int maxReverseSamples = static_cast<int>(std::ceil(maxReverseMs * currentSampleRate / 1000.0));
+    reverseSamples = static_cast<int>(reverseLengthMs * currentSampleRate / 1000.0);
+    reverseSamples = std::clamp(reverseSamples, 1, maxReverseSamples);
+
+    // Pre-delay pushes the swell past the dry note, the latency stays put
+    preDelaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0);
+    preDelaySamples = std::clamp(preDelaySamples, 0, static_cast<int>(currentSampleRate * 0.5));
+    loopSamples = reverseSamples + preDelaySamples;
+
+    // Tap gains follow a reversed exponential decay: quietest on the newest
+    // audio, rising by up to maxRiseDb to full level at the reverse length
+    const float riseDb = rise * maxRiseDb;
+    auto layoutTaps = [&](const std::array<float, numTaps>& jitter, std::array<int, numTaps>& ages,
+                          std::array<float, numTaps>& brightGains, std::array<float, numTaps>& darkGains,
+                          int polarityOffset)
+    {
+        float sumSquares = 0.0f;
+        for (int i = 0; i < numTaps; ++i)
+        {
+            float position = (static_cast<float>(i) + 0.5f + jitter[i]) / static_cast<float>(numTaps);
+            ages[i] = preDelaySamples + std::max(1, static_cast<int>(position * static_cast<float>(reverseSamples)));
+
+            float gain = DSPUtils::decibelsToLinear(-riseDb * (1.0f - position));
+            sumSquares += gain * gain;
+
+            // Alternate polarity for density, newer taps are darker
+            float polarity = ((i + polarityOffset) % 2 == 1) ? -1.0f : 1.0f;
+            float darkness = damping * (1.0f - position);
+            brightGains[i] = gain * polarity * (1.0f - darkness);
+            darkGains[i] = gain * polarity * darkness;
+        }
+
+        // Same overall level whatever the rise
+        float norm = 0.8f / std::sqrt(std::max(sumSquares, 1.0e-9f));
+        for (int i = 0; i < numTaps; ++i)
+        {
+            brightGains[i] *= norm;
+            darkGains[i] *= norm;
+        }
+    };
+
+    layoutTaps(jitterL, tapAgesL, brightGainsL, darkGainsL, 0);
+    layoutTaps(jitterR, tapAgesR, brightGainsR, darkGainsR, 1);
+
+    // Update diffusers
+    const int diffuserDelays[4] = { 107, 251, 379, 503 };
+    for (int i = 0; i < numDiffusers; ++i)
+    {
+        int delay = static_cast<int>(diffuserDelays[i] * size * currentSampleRate / 44100.0);
+        diffusers.setDelay(i, delay, static_cast<int>(delay * 1.1f));
+    }
+    diffusers.setFeedback(0.5f + diffusion * 0.3f);
+    // The taps are normalised for a unity-gain input, which the classic
+    // form is not, so it becomes a unity allpass chain here
+    diffusers.setTopology(diffuserTopology == DSPUtils::DiffuserTopology::Classic
+                              ? DSPUtils::DiffuserTopology::Unity
+                              : diffuserTopology);
+
+    // Update filters
+    highPass.setCoefficients(DSPUtils::calcHighPass(currentSampleRate, highPassFreq));
+    lowPass.setCoefficients(DSPUtils::calcLowPass(currentSampleRate, lowPassFreq));
+}
+
+void ReverseReverb::process(juce::AudioBuffer<float>& buffer)
+{
+    if (bypassed)
+        return;
+
+    if (takeParameterChanges())
+        updateParameters();
+
+    auto* leftChannel = buffer.getWritePointer(0);
+    auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
+
+    int numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        const int sliceSize = std::min(blockSize, numSamples - start);
+        float* sliceL = leftChannel + start;
+        float* sliceR = rightChannel ? rightChannel + start : nullptr;
+        const float* sliceRightInput = rightInput ? rightInput + start : nullptr;
+
+        // Input filtering, once for a mono source
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float left = sliceL[sample];
+            float right = sliceRightInput ? sliceRightInput[sample] : left;
+
+            if (sliceRightInput)
+                highPass.process(left, right);
+            else
+                left = right = highPass.processMono(left);
+
+            inputL[sample] = left;
+            inputR[sample] = right;
+        }
+
+        // Diffusion, a mono source splits into left and right here
+        diffusers.processBlock(inputL.data(), inputR.data(), sliceSize);
+
+        // Into the rings. While frozen the input fades out and the rings
+        // loop over the span of the taps instead. A plain delay loop is
+        // already lossless, so it only needs the safety limiter.
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            float inputGain = loopEnergy.getNextInputGain();
+            if (inputGain < 1.0f)
+            {
+                float loopGain = 1.0f - inputGain;
+                inputL[sample] = inputL[sample] * inputGain +
+                                 DSPUtils::LoopEnergyControl::limit(ringL.read(loopSamples)) * loopGain;
+                inputR[sample] = inputR[sample] * inputGain +
+                                 DSPUtils::LoopEnergyControl::limit(ringR.read(loopSamples)) * loopGain;
+            }
+
+            ringL.push(inputL[sample]);
+            ringR.push(inputR[sample]);
+        }
+
+        // Rising taps, split into bright and dark sums
+        std::fill(brightL.begin(), brightL.begin() + sliceSize, 0.0f);
+        std::fill(brightR.begin(), brightR.begin() + sliceSize, 0.0f);
+        std::fill(darkL.begin(), darkL.begin() + sliceSize, 0.0f);
+        std::fill(darkR.begin(), darkR.begin() + sliceSize, 0.0f);
+
+        for (int i = 0; i < numTaps; ++i)
+        {
+            ringL.addTap(brightL.data(), sliceSize, tapAgesL[i], brightGainsL[i]);
+            ringL.addTap(darkL.data(), sliceSize, tapAgesL[i], darkGainsL[i]);
+            ringR.addTap(brightR.data(), sliceSize, tapAgesR[i], brightGainsR[i]);
+            ringR.addTap(darkR.data(), sliceSize, tapAgesR[i], darkGainsR[i]);
+        }
+
+        for (int sample = 0; sample < sliceSize; ++sample)
+        {
+            darkStateL = darkL[sample] * (1.0f - darkPole) + darkStateL * darkPole;
+            darkStateR = darkR[sample] * (1.0f - darkPole) + darkStateR * darkPole;
+            float wetL = brightL[sample] + darkStateL;
+            float wetR = brightR[sample] + darkStateR;
+
+            // Output filtering
+            lowPass.process(wetL, wetR);
+
+            sliceL[sample] = wetL;
+            if (sliceR)
+                sliceR[sample] = wetR;
+        }
+    }
+
+    loopEnergy.endBlock();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReverbBase.h"
+#include "DSPUtils.h"
+#include <array>
+
+// Reverse program: the reverb swells up into each note instead of decaying
+// after it. Printing the audio, reversing, reverbing and reversing again
+// convolves it with the time-reversed impulse response, which is causal once
+// the dry path is delayed by the reverse length. So the input is kept in a
+// ring of blocks and read by a dense set of taps, GatedReverb-style, whose
+// gains rise from the newest audio to the oldest and stop where the delayed
+// dry note plays. The newer taps are also the darker ones, as the end of a
+// forward tail would be.
+//
+// The reverse length is reported as latency, and the processor delays the
+// dry path by it. Freeze loops the last reverse length of input through the
+// taps.
+class ReverseReverb : public ReverbBase
+{
+public:
+    ReverseReverb();
+
+    void prepare(double sampleRate, int samplesPerBlock) override;
+    void process(juce::AudioBuffer<float>& buffer) override;
+    void reset() override;
+
+    // Reverse-specific parameters
+    void setReverseLength(float lengthMs);   // 50-1000ms, swell length and output delay
+    void setRise(float riseAmount);          // 0-1, flat to a steep swell
+
+    float getReverseLength() const { return reverseLengthMs; }
+    float getRise() const { return rise; }
+
+    // Dry path delay for the swell to end on the note, reported to the host
+    int getLatencySamples() const { return reverseSamples; }
+
+private:
+    void updateParameters();
+
+    static constexpr float maxReverseMs = 1000.0f;
+    static constexpr float maxRiseDb = 48.0f;   // Swell range at full rise
+
+    // Dense taps per side, spread evenly over the reverse length with a
+    // fixed jitter so the two sides never line up
+    static constexpr int numTaps = 48;
+    std::array<float, numTaps> jitterL {};
+    std::array<float, numTaps> jitterR {};
+    std::array<int, numTaps> tapAgesL {};
+    std::array<int, numTaps> tapAgesR {};
+    std::array<float, numTaps> brightGainsL {};
+    std::array<float, numTaps> brightGainsR {};
+    std::array<float, numTaps> darkGainsL {};
+    std::array<float, numTaps> darkGainsR {};
+
+    float reverseLengthMs = 400.0f;
+    float rise = 0.6f;
+    int reverseSamples = 0;
+    int preDelaySamples = 0;
+    int loopSamples = 1;      // Span of the taps, looped while frozen
+
+    // Rings of blocks holding the diffused input read by the taps
+    DSPUtils::BlockDelay ringL;
+    DSPUtils::BlockDelay ringR;
+
+    // Diffusers
+    static constexpr int numDiffusers = 4;
+    DSPUtils::DiffuserBank diffusers;
+
+    // Everything runs on slices of this many samples, a stage at a time
+    static constexpr int blockSize = 64;
+    std::array<float, blockSize> inputL {};
+    std::array<float, blockSize> inputR {};
+    std::array<float, blockSize> brightL {};
+    std::array<float, blockSize> brightR {};
+    std::array<float, blockSize> darkL {};
+    std::array<float, blockSize> darkR {};
+
+    // One-pole low-pass on the dark taps
+    float darkPole = 0.0f;
+    float darkStateL = 0.0f;
+    float darkStateR = 0.0f;
+
+    // Filters
+    DSPUtils::StereoBiquad highPass;
+    DSPUtils::StereoBiquad lowPass;
+};
@@ -1,18 +1,42 @@
 #include "ShimmerReverb.h"
 #include <cmath>
 
-ShimmerReverb::ShimmerReverb()
+namespace
 {
-    // Initialize diffusers
-    for (int i = 0; i < numDiffusers; ++i)
+    constexpr uint32_t toFixedStep(double ratio)
     {
-        diffusersL[i] = DSPUtils::AllpassFilter(4096);
-        diffusersR[i] = DSPUtils::AllpassFilter(4096);
+        return static_cast<uint32_t>(ratio * 65536.0 + 0.5);
     }
 
+    // Grain read stride for each pitch mode (Mixed alternates octave and fifth grains)
+    constexpr uint32_t getPitchStep(ShimmerPitch mode, bool secondaryGrain)
+    {
+        switch (mode)
+        {
+            case ShimmerPitch::OctaveUp:   return toFixedStep(2.0);
+            case ShimmerPitch::FifthUp:    return toFixedStep(1.5);
+            case ShimmerPitch::OctaveDown: return toFixedStep(0.5);
+            case ShimmerPitch::FifthDown:  return toFixedStep(0.667);
+            case ShimmerPitch::Mixed:      return toFixedStep(secondaryGrain ? 1.5 : 2.0);
+        }
+        return toFixedStep(1.0);
+    }
+}
+
+ShimmerReverb::ShimmerReverb()
+{
     // Initialize modulated delay lines
     modulatedDelays[0] = DSPUtils::ModulatedDelayLine(48000);
     modulatedDelays[1] = DSPUtils::ModulatedDelayLine(48000);
+
+    // Grain envelope is sample-rate independent, so build it once
+    for (int i = 0; i < grainSize; ++i)
+    {
+        float hann = 0.5f * (1.0f - std::cos(2.0f * 3.14159265358979323846f * i / (grainSize - 1)));
+        grainWindow[i] = hann / numGrains;
+    }
+
+    granularKernel = getGranularKernel(pitchMode);
 }
 
 void ShimmerReverb::prepare(double sampleRate, int samplesPerBlock)
@@ -20,6 +44,10 @@ void ShimmerReverb::prepare(double sampleRate, int samplesPerBlock)
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
+    // Diffuser arena, sized for the longest stage at full size
+    int maxDiffuserDelay = static_cast<int>(std::ceil(701 * 1.12f * sampleRate / 44100.0)) + 1;
+    diffusers.prepare(numDiffusers, maxDiffuserDelay, sampleRate);
+
     // Allocate grain buffers
     for (int ch = 0; ch < 2; ++ch)
     {
@@ -29,21 +57,13 @@ void ShimmerReverb::prepare(double sampleRate, int samplesPerBlock)
         // Initialize grains with staggered positions
         for (int g = 0; g < numGrains; ++g)
         {
-            grains[ch][g].readPosition = 0.0f;
-            grains[ch][g].readIncrement = 1.0f;
+            grains[ch][g].readPosition = 0;
             grains[ch][g].startOffset = g * (grainSize / numGrains);
             grains[ch][g].amplitude = 0.0f;
             grains[ch][g].age = g * (grainSize / numGrains);
         }
     }
 
-    // Create Hann window
-    hannWindow.resize(grainSize);
-    for (int i = 0; i < grainSize; ++i)
-    {
-        hannWindow[i] = 0.5f * (1.0f - std::cos(2.0f * 3.14159265358979323846f * i / (grainSize - 1)));
-    }
-
     // Allocate FDN delay lines
     int maxFdnSamples = static_cast<int>(sampleRate * 0.15);
     const int fdnDelays[4] = { 1087, 1423, 1777, 2131 };
@@ -59,10 +79,8 @@ void ShimmerReverb::prepare(double sampleRate, int samplesPerBlock)
     // Setup filters
     auto hpCoeffs = DSPUtils::calcHighPass(sampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(sampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // Setup modulated delays
     modulatedDelays[0].setDelay(static_cast<float>(sampleRate * 0.03f));
@@ -70,6 +88,10 @@ void ShimmerReverb::prepare(double sampleRate, int samplesPerBlock)
     modulatedDelays[0].setModDepth(sampleRate * 0.003f);
     modulatedDelays[1].setModDepth(sampleRate * 0.003f);
 
+    loopEnergy.prepare(sampleRate);
+    tankAnalyzer.prepare(sampleRate);
+    formantPreserver.prepare(sampleRate);
+
     updateParameters();
     reset();
 }
@@ -87,24 +109,22 @@ void ShimmerReverb::reset()
         std::fill(fdnDelayLines[i].begin(), fdnDelayLines[i].end(), 0.0f);
         fdnWriteIndices[i] = 0;
         fdnFilterStates[i] = 0.0f;
+        loopSaturators[i].reset();
     }
 
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i].reset();
-        diffusersR[i].reset();
-    }
+    diffusers.reset();
 
     modulatedDelays[0].reset();
     modulatedDelays[1].reset();
 
-    highPassL.reset();
-    highPassR.reset();
-    lowPassL.reset();
-    lowPassR.reset();
+    highPass.reset();
+    lowPass.reset();
 
     feedbackAccumL = 0.0f;
     feedbackAccumR = 0.0f;
+    loopEnergy.reset();
+    tankAnalyzer.reset();
+    formantPreserver.reset();
     lfoPhase = 0.0f;
     grainTriggerCounter = 0;
     currentGrain = 0;
@@ -124,26 +144,39 @@ void ShimmerReverb::setShimmerAmount(float amount)
 void ShimmerReverb::setInfinite(bool infinite)
 {
     infiniteMode = infinite;
+    loopEnergy.setFrozen(holdsTail());
 }
 
-float ShimmerReverb::getPitchRatio() const
+void ShimmerReverb::setSaturation(float amount)
 {
-    switch (pitchMode)
+    float newSaturation = std::clamp(amount, 0.0f, 1.0f);
+
+    // The saturators do not run at zero drive, so their history is stale
+    if (saturation <= 0.0f && newSaturation > 0.0f)
     {
-        case ShimmerPitch::OctaveUp:   return 2.0f;
-        case ShimmerPitch::FifthUp:    return 1.5f;
-        case ShimmerPitch::OctaveDown: return 0.5f;
-        case ShimmerPitch::FifthDown:  return 0.667f;
-        case ShimmerPitch::Mixed:      return 2.0f;
-        default: return 1.0f;
+        for (auto& saturator : loopSaturators)
+            saturator.reset();
     }
+
+    saturation = newSaturation;
 }
 
-float ShimmerReverb::getSecondaryPitchRatio() const
+void ShimmerReverb::setFormantPreserve(bool shouldPreserve)
 {
-    if (pitchMode == ShimmerPitch::Mixed)
-        return 1.5f;  // Fifth up as secondary
-    return getPitchRatio();
+    formantPreserve = shouldPreserve;
+}
+
+ShimmerReverb::GranularKernel ShimmerReverb::getGranularKernel(ShimmerPitch mode)
+{
+    switch (mode)
+    {
+        case ShimmerPitch::OctaveUp:   return &ShimmerReverb::processGranular<ShimmerPitch::OctaveUp>;
+        case ShimmerPitch::FifthUp:    return &ShimmerReverb::processGranular<ShimmerPitch::FifthUp>;
+        case ShimmerPitch::OctaveDown: return &ShimmerReverb::processGranular<ShimmerPitch::OctaveDown>;
+        case ShimmerPitch::FifthDown:  return &ShimmerReverb::processGranular<ShimmerPitch::FifthDown>;
+        case ShimmerPitch::Mixed:      return &ShimmerReverb::processGranular<ShimmerPitch::Mixed>;
+    }
+    return &ShimmerReverb::processGranular<ShimmerPitch::OctaveUp>;
 }
 
 void ShimmerReverb::updateParameters()
@@ -153,11 +186,14 @@ void ShimmerReverb::updateParameters()
     for (int i = 0; i < numDiffusers; ++i)
     {
         int delay = static_cast<int>(diffuserDelays[i] * size * currentSampleRate / 44100.0);
-        diffusersL[i].setDelay(std::clamp(delay, 1, 4095));
-        diffusersR[i].setDelay(std::clamp(static_cast<int>(delay * 1.12f), 1, 4095));
-        diffusersL[i].setFeedback(0.4f + diffusion * 0.35f);
-        diffusersR[i].setFeedback(0.4f + diffusion * 0.35f);
+        diffusers.setDelay(i, delay, static_cast<int>(delay * 1.12f));
     }
+    diffusers.setFeedback(0.4f + diffusion * 0.35f);
+    // The diffusers sit inside the feedback loop, where the classic form
+    // would add gain, so it becomes a unity allpass chain here
+    diffusers.setTopology(diffuserTopology == DSPUtils::DiffuserTopology::Classic
+                              ? DSPUtils::DiffuserTopology::Unity
+                              : diffuserTopology);
 
     // Update FDN delay lengths based on size
     const int fdnDelays[4] = { 1087, 1423, 1777, 2131 };
@@ -171,10 +207,8 @@ void ShimmerReverb::updateParameters()
     // Update filters
     auto hpCoeffs = DSPUtils::calcHighPass(currentSampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(currentSampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // Update modulated delays
     modulatedDelays[0].setDelay(static_cast<float>(currentSampleRate * 0.025f * size));
@@ -183,58 +217,71 @@ void ShimmerReverb::updateParameters()
     modulatedDelays[1].setModDepth(currentSampleRate * 0.002f * modDepth);
 }
 
+template <uint32_t Step>
+float ShimmerReverb::processGrain(Grain& grain, const float* buffer, int writeIndex)
+{
+    const int readIdx1 = static_cast<int>(grain.readPosition >> readFracBits);
+    float sample;
+
+    if constexpr ((Step & readFracMask) == 0)
+    {
+        // Whole-sample stride (octave up): always lands on a stored sample
+        sample = buffer[readIdx1];
+    }
+    else if constexpr ((Step & (readFracMask >> 1)) == 0)
+    {
+        // Half-sample stride (fifth up, octave down): either on a sample or exactly between two
+        sample = buffer[readIdx1];
+        if ((grain.readPosition & readFracMask) != 0)
+            sample = 0.5f * (sample + buffer[(readIdx1 + 1) & grainBufferMask]);
+    }
+    else
+    {
+        // Arbitrary ratio: linear interpolation
+        const int readIdx2 = (readIdx1 + 1) & grainBufferMask;
+        const float frac = static_cast<float>(grain.readPosition & readFracMask) * (1.0f / (1 << readFracBits));
+        sample = buffer[readIdx1] + (buffer[readIdx2] - buffer[readIdx1]) * frac;
+    }
+
+    // Age never exceeds grainSize, so the window is indexed directly
+    float output = sample * grainWindow[grain.age] * grain.amplitude;
+
+    // Advance grain read position (pitch shift)
+    grain.readPosition = (grain.readPosition + Step) & readPositionMask;
+    grain.age++;
+
+    // Reset grain when it reaches the end
+    if (grain.age >= grainSize)
+    {
+        grain.age = 0;
+        grain.readPosition = static_cast<uint32_t>((writeIndex - grainSize / 2) & grainBufferMask) << readFracBits;
+        grain.amplitude = 1.0f;
+    }
+
+    return output;
+}
+
+template <ShimmerPitch Mode>
 void ShimmerReverb::processGranular(float inputL, float inputR, float& outL, float& outR)
 {
-    float pitchRatio = getPitchRatio();
-    float pitchRatio2 = getSecondaryPitchRatio();
+    constexpr uint32_t primaryStep = getPitchStep(Mode, false);
+    constexpr uint32_t secondaryStep = getPitchStep(Mode, true);
 
     // Write input to grain buffers
     grainBuffers[0][grainWriteIndices[0]] = inputL;
     grainBuffers[1][grainWriteIndices[1]] = inputR;
 
-    outL = 0.0f;
-    outR = 0.0f;
-
-    // Process each grain
+    // Process each grain (odd grains carry the secondary interval in Mixed mode)
     for (int ch = 0; ch < 2; ++ch)
     {
+        const float* buffer = grainBuffers[ch].data();
+        auto& channelGrains = grains[ch];
         float channelOut = 0.0f;
 
-        for (int g = 0; g < numGrains; ++g)
+        for (int g = 0; g < numGrains; g += 2)
         {
-            Grain& grain = grains[ch][g];
-
-            // Calculate window position and apply envelope
-            int windowPos = grain.age % grainSize;
-            float envelope = hannWindow[windowPos];
-
-            // Read from buffer with interpolation
-            float readPos = grain.readPosition;
-            int readIdx1 = static_cast<int>(readPos) % grainBufferSize;
-            int readIdx2 = (readIdx1 + 1) % grainBufferSize;
-            float frac = readPos - static_cast<float>(static_cast<int>(readPos));
-
-            float sample = grainBuffers[ch][readIdx1] * (1.0f - frac) +
-                          grainBuffers[ch][readIdx2] * frac;
-
-            channelOut += sample * envelope * grain.amplitude;
-
-            // Advance grain read position (pitch shift)
-            float grainPitch = (g % 2 == 0 || pitchMode != ShimmerPitch::Mixed) ? pitchRatio : pitchRatio2;
-            grain.readPosition += grainPitch;
-            if (grain.readPosition >= grainBufferSize)
-                grain.readPosition -= grainBufferSize;
-
-            grain.age++;
-
-            // Reset grain when it reaches the end
-            if (grain.age >= grainSize)
-            {
-                grain.age = 0;
-                grain.readPosition = static_cast<float>(grainWriteIndices[ch] - grainSize / 2);
-                if (grain.readPosition < 0) grain.readPosition += grainBufferSize;
-                grain.amplitude = 1.0f / numGrains;
-            }
+            channelOut += processGrain<primaryStep>(channelGrains[g], buffer, grainWriteIndices[ch]);
+            channelOut += processGrain<secondaryStep>(channelGrains[g + 1], buffer, grainWriteIndices[ch]);
         }
 
         if (ch == 0)
@@ -244,8 +291,8 @@ void ShimmerReverb::processGranular(float inputL, float inputR, float& outL, flo
     }
 
     // Advance write indices
-    grainWriteIndices[0] = (grainWriteIndices[0] + 1) % grainBufferSize;
-    grainWriteIndices[1] = (grainWriteIndices[1] + 1) % grainBufferSize;
+    grainWriteIndices[0] = (grainWriteIndices[0] + 1) & grainBufferMask;
+    grainWriteIndices[1] = (grainWriteIndices[1] + 1) & grainBufferMask;
 }
 
 void ShimmerReverb::process(juce::AudioBuffer<float>& buffer)
@@ -253,16 +300,26 @@ void ShimmerReverb::process(juce::AudioBuffer<float>& buffer)
     if (bypassed)
         return;
 
-    updateParameters();
+    if (takeParameterChanges())
+        updateParameters();
 
     auto* leftChannel = buffer.getWritePointer(0);
     auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
 
     int numSamples = buffer.getNumSamples();
 
+    // Pitch mode only changes between blocks
+    granularKernel = getGranularKernel(pitchMode);
+
     // Calculate feedback
     float feedback;
-    if (freeze || infiniteMode || decaySeconds >= 30.0f)
+    const bool tailHeld = holdsTail();
+    if (tailHeld)
+    {
+        feedback = 1.0f;  // Lossless loop, level held by loopEnergy
+    }
+    else if (decaySeconds >= 30.0f)
     {
         feedback = 0.998f;
     }
@@ -277,29 +334,73 @@ void ShimmerReverb::process(juce::AudioBuffer<float>& buffer)
         feedback = std::clamp(feedback, 0.0f, 0.995f);
     }
 
+    const float loopDamping = tailHeld ? 0.0f : damping;
+
+    // The tank output re-enters through the pitch shifter (injection gain 0.5,
+    // grain overlap-add gain 0.5) as well as recirculating directly. Split the
+    // loop gain between the two paths so the total stays at 'feedback'.
+    const float shiftedPathGain = 0.5f * (1.0f - shimmerAmount * 0.5f);
+    const float directLoopShare = 1.0f - shiftedPathGain;
+
+    // Loop saturation keeps unity small-signal gain, so it only acts on
+    // material that builds up (infinite mode, high shimmer amounts). The
+    // antialiased saturator averages over each sample interval, a half-sample
+    // low-pass that would darken the tank on every pass, so it is blended in
+    // with the drive rather than switched in whole.
+    const bool saturate = saturation > 0.0f;
+    const float loopDrive = 1.0f + saturation * 7.0f;
+    const float loopMakeup = 1.0f / loopDrive;
+
+    const bool analyzerActive = tankAnalyzer.isEnabled();
+
     for (int sample = 0; sample < numSamples; ++sample)
     {
         float inputL = leftChannel[sample];
-        float inputR = rightChannel ? rightChannel[sample] : inputL;
+        float inputR = rightInput ? rightInput[sample] : inputL;
 
-        // Input filtering
-        inputL = highPassL.process(inputL);
-        inputR = highPassR.process(inputR);
+        // Input filtering (input into the tank fades out while frozen)
+        float tankInputGain = loopEnergy.getNextInputGain();
+        if (rightInput)
+        {
+            highPass.process(inputL, inputR);
+            inputL *= tankInputGain;
+            inputR *= tankInputGain;
+        }
+        else
+        {
+            // Mono source: filter once, the feedback paths decorrelate it
+            inputR = inputL = highPass.processMono(inputL) * tankInputGain;
+        }
 
         // Add feedback from previous iteration
         float feedbackInputL = inputL + feedbackAccumL * feedback;
         float feedbackInputR = inputR + feedbackAccumR * feedback;
 
-        // Diffusion
-        for (int i = 0; i < numDiffusers; ++i)
+        // Diffusion (inside the feedback loop, so it must not add gain)
+        diffusers.process(feedbackInputL, feedbackInputR);
+
+        // Pitch shifting (granular), optionally on the whitened signal so the
+        // envelope of the incoming material can be put back unshifted afterwards
+        float shifterInputL = feedbackInputL;
+        float shifterInputR = feedbackInputR;
+        // The envelope is re-estimated once per analysis hop
+        if (formantPreserver.pushAnalysis(0.5f * (inputL + inputR)) && formantPreserve)
+            formantPreserver.update();
+
+        if (formantPreserve)
         {
-            feedbackInputL = diffusersL[i].process(feedbackInputL);
-            feedbackInputR = diffusersR[i].process(feedbackInputR);
+            shifterInputL = formantPreserver.whiten(shifterInputL, 0);
+            shifterInputR = formantPreserver.whiten(shifterInputR, 1);
         }
 
-        // Pitch shifting (granular)
         float shiftedL, shiftedR;
-        processGranular(feedbackInputL, feedbackInputR, shiftedL, shiftedR);
+        (this->*granularKernel)(shifterInputL, shifterInputR, shiftedL, shiftedR);
+
+        if (formantPreserve)
+        {
+            shiftedL = formantPreserver.recolour(shiftedL, 0);
+            shiftedR = formantPreserver.recolour(shiftedR, 1);
+        }
 
         // Blend original and pitch-shifted
         float blendL = feedbackInputL * (1.0f - shimmerAmount) + shiftedL * shimmerAmount;
@@ -337,15 +438,25 @@ void ShimmerReverb::process(juce::AudioBuffer<float>& buffer)
             mixedOutputs[i] = sum - delayOutputs[i];
         }
 
-        // Write back to FDN with damping
+        // Write back to FDN with damping (bypassed while frozen)
         for (int i = 0; i < fdnSize; ++i)
         {
-            float dampedOutput = mixedOutputs[i] * (1.0f - damping) + fdnFilterStates[i] * damping;
+            float dampedOutput = mixedOutputs[i] * (1.0f - loopDamping) + fdnFilterStates[i] * loopDamping;
             fdnFilterStates[i] = dampedOutput;
 
-            float feedbackSample = dampedOutput * feedback;
+            float feedbackSample = dampedOutput * feedback * directLoopShare;
             float newSample = (i < 2) ? modDelayL * 0.5f + feedbackSample : modDelayR * 0.5f + feedbackSample;
 
+            if (saturate)
+            {
+                float saturated = loopSaturators[i].process(newSample * loopDrive) * loopMakeup;
+                newSample += (saturated - newSample) * saturation;
+            }
+
+            // The injected signal is itself fed back through the pitch shifter,
+            // so energy control and limiting apply to the whole write
+            newSample = loopEnergy.process(newSample);
+
             int bufSize = static_cast<int>(fdnDelayLines[i].size());
             fdnDelayLines[i][fdnWriteIndices[i]] = newSample;
 
@@ -361,22 +472,18 @@ void ShimmerReverb::process(juce::AudioBuffer<float>& buffer)
         feedbackAccumL = fdnOutL;
         feedbackAccumR = fdnOutR;
 
-        // Apply width
-        float mid = (fdnOutL + fdnOutR) * 0.5f;
-        float side = (fdnOutL - fdnOutR) * 0.5f;
-        float wetL = mid + side * width;
-        float wetR = mid - side * width;
+        if (analyzerActive)
+            tankAnalyzer.pushSample(fdnOutL + fdnOutR);
 
         // Output filtering
-        wetL = lowPassL.process(wetL);
-        wetR = lowPassR.process(wetR);
+        float wetL = fdnOutL;
+        float wetR = fdnOutR;
+        lowPass.process(wetL, wetR);
 
-        // Mix
-        float dryL = leftChannel[sample];
-        float dryR = rightChannel ? rightChannel[sample] : dryL;
-
-        leftChannel[sample] = dryL * (1.0f - mix) + wetL * mix;
+        leftChannel[sample] = wetL;
         if (rightChannel)
-            rightChannel[sample] = dryR * (1.0f - mix) + wetR * mix;
+            rightChannel[sample] = wetR;
     }
+
+    loopEnergy.endBlock();
 }
@@ -3,8 +3,10 @@
 #include <JuceHeader.h>
 #include "ReverbBase.h"
 #include "DSPUtils.h"
+#include "TankAnalyzer.h"
 #include <array>
 #include <complex>
+#include <cstdint>
 
 // Shimmer pitch shift modes
 enum class ShimmerPitch
@@ -28,34 +30,50 @@ public:
     void setPitchMode(ShimmerPitch newMode);
     void setShimmerAmount(float amount);  // 0-1 blend of pitched signal
     void setInfinite(bool infinite);
+    void setSaturation(float amount);     // 0-1 drive of the in-loop saturator
+    void setFormantPreserve(bool shouldPreserve);
 
     ShimmerPitch getPitchMode() const { return pitchMode; }
     bool isInfinite() const { return infiniteMode; }
 
+    // Infinite mode sustains the tank the same way freeze does
+    bool holdsTail() const override { return freeze || infiniteMode; }
+
+    // Spectrum of the feedback loop, for the editor's tank view
+    TankAnalyzer& getTankAnalyzer() { return tankAnalyzer; }
+
 private:
     void updateParameters();
     float pitchShift(float input, float pitchRatio, int channel);
-    void processGranular(float inputL, float inputR, float& outL, float& outR);
 
     ShimmerPitch pitchMode = ShimmerPitch::OctaveUp;
     float shimmerAmount = 0.5f;
     bool infiniteMode = false;
+    float saturation = 0.0f;
+    bool formantPreserve = false;
 
-    // Granular pitch shifter buffers
+    // Granular pitch shifter buffers (sizes are powers of two so indices wrap with a mask)
     static constexpr int grainBufferSize = 8192;
+    static constexpr int grainBufferMask = grainBufferSize - 1;
     static constexpr int numGrains = 4;
     static constexpr int grainSize = 2048;
+    static_assert(numGrains % 2 == 0, "Grains are processed in primary/secondary pairs");
 
     std::array<std::vector<float>, 2> grainBuffers;  // L/R
     std::array<int, 2> grainWriteIndices = { 0, 0 };
 
+    // Grain read positions are 16.16 fixed point, so octave/fifth strides
+    // land exactly on whole or half samples
+    static constexpr int readFracBits = 16;
+    static constexpr uint32_t readFracMask = (1u << readFracBits) - 1u;
+    static constexpr uint32_t readPositionMask = (static_cast<uint32_t>(grainBufferSize) << readFracBits) - 1u;
+
     // Grain playback state
     struct Grain
     {
-        float readPosition = 0.0f;
-        float readIncrement = 1.0f;
+        uint32_t readPosition = 0;
         int startOffset = 0;
-        float amplitude = 0.0f;
+        float amplitude = 0.0f;  // 0 until the grain has been triggered once
         int age = 0;
     };
 
@@ -63,6 +81,18 @@ private:
     int grainTriggerCounter = 0;
     int currentGrain = 0;
 
+    // Granular pitch shifter, specialised per pitch mode so the read
+    // strides are compile-time constants. The kernel is picked once per block.
+    template <ShimmerPitch Mode>
+    void processGranular(float inputL, float inputR, float& outL, float& outR);
+
+    template <uint32_t Step>
+    float processGrain(Grain& grain, const float* buffer, int writeIndex);
+
+    using GranularKernel = void (ShimmerReverb::*)(float, float, float&, float&);
+    static GranularKernel getGranularKernel(ShimmerPitch mode);
+    GranularKernel granularKernel = nullptr;
+
     // Reverb network (simplified FDN for shimmer)
     static constexpr int fdnSize = 4;
     std::array<std::vector<float>, fdnSize> fdnDelayLines;
@@ -75,12 +105,11 @@ private:
 
     // Diffusers
     static constexpr int numDiffusers = 4;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersL;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersR;
+    DSPUtils::DiffuserBank diffusers;
 
     // Filters
-    DSPUtils::BiquadFilter highPassL, highPassR;
-    DSPUtils::BiquadFilter lowPassL, lowPassR;
+    DSPUtils::StereoBiquad highPass;
+    DSPUtils::StereoBiquad lowPass;
 
     // LFO for modulation
     float lfoPhase = 0.0f;
@@ -89,10 +118,15 @@ private:
     float feedbackAccumL = 0.0f;
     float feedbackAccumR = 0.0f;
 
-    // Pitch ratios
-    float getPitchRatio() const;
-    float getSecondaryPitchRatio() const;
+    // Spectral envelope around the pitch shifter for formant preservation
+    DSPUtils::FormantPreserver formantPreserver;
+
+    // Soft saturation on each FDN write
+    std::array<DSPUtils::AntiAliasedSaturator, fdnSize> loopSaturators;
+
+    // Feedback loop tap
+    TankAnalyzer tankAnalyzer;
 
-    // Hann window for grain envelope
-    std::vector<float> hannWindow;
+    // Hann window for grain envelope, pre-scaled by 1/numGrains
+    std::array<float, grainSize> grainWindow;
 };
@@ -1,63 +1,67 @@
 #include "SpringReverb.h"
 #include <cmath>
 
-SpringReverb::SpringReverb()
-{
-    // Initialize diffusers
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i] = DSPUtils::AllpassFilter(2048);
-        diffusersR[i] = DSPUtils::AllpassFilter(2048);
-    }
-}
-
 void SpringReverb::prepare(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
+    // Diffuser arena, sized for the longest stage at full size
+    int maxDiffuserDelay = static_cast<int>(std::ceil(367 * 1.1f * sampleRate / 44100.0)) + 1;
+    diffusers.prepare(numDiffusers, maxDiffuserDelay, sampleRate);
+
     // Allocate pre-delay buffer
     int maxPreDelaySamples = static_cast<int>(sampleRate * 0.5);
     preDelayBufferL.resize(maxPreDelaySamples, 0.0f);
     preDelayBufferR.resize(maxPreDelaySamples, 0.0f);
 
-    // Initialize spring delay lines
-    int maxDelaySamples = static_cast<int>(sampleRate * 0.15);
-    for (int s = 0; s < numSprings; ++s)
+    // Real tanks hang springs of two wire gauges side by side. The thinner
+    // ones are wound a little shorter and sit slacker, so they chirp less
+    // and ring at a different pitch from their neighbours.
+    auto voiceTank = [](auto& tank)
     {
-        springsL[s].delayLine.resize(maxDelaySamples, 0.0f);
-        springsL[s].allpassBuffer.resize(1024, 0.0f);
-        springsL[s].delayLength = static_cast<int>(baseDelayLengths[s] * sampleRate / 44100.0);
-        springsL[s].writeIndex = 0;
-        springsL[s].allpassWriteIndex = 0;
-        springsL[s].filterState = 0.0f;
-        springsL[s].allpassState = 0.0f;
-        springsL[s].chirpState1 = 0.0f;
-        springsL[s].chirpState2 = 0.0f;
-
-        springsR[s].delayLine.resize(maxDelaySamples, 0.0f);
-        springsR[s].allpassBuffer.resize(1024, 0.0f);
-        // Slight stereo offset
-        springsR[s].delayLength = static_cast<int>(baseDelayLengths[s] * 1.07f * sampleRate / 44100.0);
-        springsR[s].writeIndex = 0;
-        springsR[s].allpassWriteIndex = 0;
-        springsR[s].filterState = 0.0f;
-        springsR[s].allpassState = 0.0f;
-        springsR[s].chirpState1 = 0.0f;
-        springsR[s].chirpState2 = 0.0f;
-    }
+        for (int spring = 1; spring < tank.getNumSprings(); spring += 2)
+            tank.setSpringOffset(spring, 0.94f, -0.1f);
+    };
+    voiceTank(tank2);
+    voiceTank(tank3);
+    voiceTank(tank4);
+    voiceTank(tank6);
+
+    // Spring tanks are sized for the oversampled rate so neither the quality
+    // nor the spring-count switch ever allocates
+    tank2.prepare(sampleRate * 2.0);
+    tank3.prepare(sampleRate * 2.0);
+    tank4.prepare(sampleRate * 2.0);
+    tank6.prepare(sampleRate * 2.0);
+
+    activeTank = getTank(springCountRequested);
+
+    // 2x polyphase IIR half-band oversampler for the spring model
+    oversampler = std::make_unique<juce::dsp::Oversampling<float>>(
+        2, 1, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
+    oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+    tankBuffer.setSize(2, samplesPerBlock);
+    diffusedBuffer.setSize(2, samplesPerBlock);
+
+    oversampled = oversamplingRequested;
+    applySpringRate();
 
     // Setup filters
     auto hpCoeffs = DSPUtils::calcHighPass(sampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(sampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // Spring response is band-limited
-    springLPL.setCutoff(sampleRate, 4000.0f);
-    springLPR.setCutoff(sampleRate, 4000.0f);
+    springLP.setCutoff(springSampleRate, 4000.0f);
+
+    springFadeStep = 1.0f / static_cast<float>(sampleRate * 0.01);  // 10ms swap fade
+
+    // Kick rattle dies away in a few milliseconds
+    kickDecay = std::exp(-1.0f / static_cast<float>(sampleRate * 0.004));
+
+    loopEnergy.prepare(sampleRate);
 
     updateParameters();
     reset();
@@ -69,53 +73,60 @@ void SpringReverb::reset()
     std::fill(preDelayBufferR.begin(), preDelayBufferR.end(), 0.0f);
     preDelayWriteIndex = 0;
 
-    for (int s = 0; s < numSprings; ++s)
-    {
-        std::fill(springsL[s].delayLine.begin(), springsL[s].delayLine.end(), 0.0f);
-        std::fill(springsL[s].allpassBuffer.begin(), springsL[s].allpassBuffer.end(), 0.0f);
-        springsL[s].writeIndex = 0;
-        springsL[s].allpassWriteIndex = 0;
-        springsL[s].filterState = 0.0f;
-        springsL[s].allpassState = 0.0f;
-        springsL[s].chirpState1 = 0.0f;
-        springsL[s].chirpState2 = 0.0f;
-
-        std::fill(springsR[s].delayLine.begin(), springsR[s].delayLine.end(), 0.0f);
-        std::fill(springsR[s].allpassBuffer.begin(), springsR[s].allpassBuffer.end(), 0.0f);
-        springsR[s].writeIndex = 0;
-        springsR[s].allpassWriteIndex = 0;
-        springsR[s].filterState = 0.0f;
-        springsR[s].allpassState = 0.0f;
-        springsR[s].chirpState1 = 0.0f;
-        springsR[s].chirpState2 = 0.0f;
-    }
+    clearSprings();
+    springGain = 0.0f;  // Silent anyway, and a pending swap can happen at once
 
-    for (int i = 0; i < numDiffusers; ++i)
-    {
-        diffusersL[i].reset();
-        diffusersR[i].reset();
-    }
+    diffusers.reset();
+
+    highPass.reset();
+    lowPass.reset();
+
+    kickFastEnvelope.reset();
+    kickSlowEnvelope.reset();
+    kickCountdown = -1;
+    kickHoldoff = 0;
+    kickLevel = 0.0f;
+
+    loopEnergy.reset();
+}
 
-    highPassL.reset();
-    highPassR.reset();
-    lowPassL.reset();
-    lowPassR.reset();
-    springLPL.reset();
-    springLPR.reset();
+void SpringReverb::clearSprings()
+{
+    activeTank->reset();
+    springLP.reset();
+
+    if (oversampler)
+        oversampler->reset();
+
+    // A cleared tank snaps to its settings on the next update
+    parametersDirty = true;
+}
+
+void SpringReverb::applySpringRate()
+{
+    springSampleRate = currentSampleRate * (oversampled ? 2.0 : 1.0);
+    parametersDirty = true;
+}
 
-    dripPhase = 0.0f;
-    dripNoise = 0.0f;
+SpringTankBase* SpringReverb::getTank(int count)
+{
+    switch (count)
+    {
+        case 2: return &tank2;
+        case 4: return &tank4;
+        case 6: return &tank6;
+        default: return &tank3;
+    }
 }
 
 void SpringReverb::setTension(float tensionAmount)
 {
-    tension = std::clamp(tensionAmount, 0.0f, 1.0f);
-    updateParameters();
+    setParameter(tension, std::clamp(tensionAmount, 0.0f, 1.0f));
 }
 
 void SpringReverb::setDrip(float dripAmount)
 {
-    drip = std::clamp(dripAmount, 0.0f, 1.0f);
+    setParameter(drip, std::clamp(dripAmount, 0.0f, 1.0f));
 }
 
 void SpringReverb::setSpringMix(float springAmount)
@@ -123,132 +134,115 @@ void SpringReverb::setSpringMix(float springAmount)
     springMix = std::clamp(springAmount, 0.0f, 1.0f);
 }
 
+void SpringReverb::setKick(float kickAmount)
+{
+    kick = std::clamp(kickAmount, 0.0f, 1.0f);
+}
+
+void SpringReverb::setOversampling(bool shouldOversample)
+{
+    // Picked up at the start of the next block
+    oversamplingRequested = shouldOversample;
+}
+
+void SpringReverb::setSpringCount(int count)
+{
+    // Picked up at the start of the next block
+    springCountRequested = getTank(count)->getNumSprings();
+}
+
 void SpringReverb::updateParameters()
 {
     // Calculate pre-delay
     preDelaySamples = static_cast<int>(preDelayMs * currentSampleRate / 1000.0);
     preDelaySamples = std::clamp(preDelaySamples, 0, static_cast<int>(preDelayBufferL.size()) - 1);
 
-    // Update spring delay lengths based on size and tension
-    int maxDelaySamples = static_cast<int>(springsL[0].delayLine.size()) - 1;
-    for (int s = 0; s < numSprings; ++s)
-    {
-        float tensionFactor = 0.7f + tension * 0.6f;  // Higher tension = shorter delay (higher pitch)
-        float sizeFactor = 0.5f + size * 1.0f;
-
-        springsL[s].delayLength = static_cast<int>(baseDelayLengths[s] * sizeFactor / tensionFactor *
-                                                   currentSampleRate / 44100.0);
-        springsL[s].delayLength = std::clamp(springsL[s].delayLength, 100, maxDelaySamples);
-
-        springsR[s].delayLength = static_cast<int>(baseDelayLengths[s] * 1.07f * sizeFactor / tensionFactor *
-                                                   currentSampleRate / 44100.0);
-        springsR[s].delayLength = std::clamp(springsR[s].delayLength, 100, maxDelaySamples);
-    }
-
     // Update diffusers
     const int diffuserDelays[3] = { 97, 211, 367 };
     for (int i = 0; i < numDiffusers; ++i)
     {
         int delay = static_cast<int>(diffuserDelays[i] * size * currentSampleRate / 44100.0);
-        diffusersL[i].setDelay(std::clamp(delay, 1, 2047));
-        diffusersR[i].setDelay(std::clamp(static_cast<int>(delay * 1.1f), 1, 2047));
-        diffusersL[i].setFeedback(0.3f + diffusion * 0.35f);
-        diffusersR[i].setFeedback(0.3f + diffusion * 0.35f);
+        diffusers.setDelay(i, delay, static_cast<int>(delay * 1.1f));
     }
+    diffusers.setFeedback(0.3f + diffusion * 0.35f);
+    diffusers.setTopology(diffuserTopology);
 
     // Update filters
     auto hpCoeffs = DSPUtils::calcHighPass(currentSampleRate, highPassFreq);
     auto lpCoeffs = DSPUtils::calcLowPass(currentSampleRate, lowPassFreq);
-    highPassL.setCoefficients(hpCoeffs);
-    highPassR.setCoefficients(hpCoeffs);
-    lowPassL.setCoefficients(lpCoeffs);
-    lowPassR.setCoefficients(lpCoeffs);
+    highPass.setCoefficients(hpCoeffs);
+    lowPass.setCoefficients(lpCoeffs);
 
     // Spring characteristic frequency based on tension
     float springCutoff = 2000.0f + tension * 3000.0f;
-    springLPL.setCutoff(currentSampleRate, springCutoff);
-    springLPR.setCutoff(currentSampleRate, springCutoff);
+    springLP.setCutoff(springSampleRate, springCutoff);
 }
 
-float SpringReverb::processSpringModel(float input, int channel)
+void SpringReverb::updateSpringTank()
 {
-    auto& springs = (channel == 0) ? springsL : springsR;
-    float output = 0.0f;
+    SpringTankSettings settings;
+    settings.sampleRate = springSampleRate;
+    settings.tension = tension;
+    settings.size = size;
+    settings.decaySeconds = decaySeconds;
+    settings.drip = drip;
+    settings.freeze = freeze;
+
+    // Damping is a per-sample one-pole, so its pole is rescaled to keep the
+    // same response when the springs run oversampled
+    float loopDamping = freeze ? 0.0f : damping;
+    settings.loopDamping = oversampled ? std::sqrt(loopDamping) : loopDamping;
+
+    activeTank->update(settings);
+}
 
-    // Calculate feedback coefficient from decay
-    float feedback;
-    if (freeze || decaySeconds >= 30.0f)
-    {
-        feedback = 0.995f;
-    }
-    else
-    {
-        float avgDelay = 0.0f;
-        for (int s = 0; s < numSprings; ++s)
-            avgDelay += springs[s].delayLength;
-        avgDelay /= numSprings;
+void SpringReverb::detectTransient(const juce::AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    if (numSamples == 0)
+        return;
 
-        feedback = std::pow(10.0f, -3.0f * avgDelay / (decaySeconds * currentSampleRate));
-        feedback = std::clamp(feedback, 0.0f, 0.98f);
-    }
+    kickHoldoff = std::max(0, kickHoldoff - numSamples);
 
-    for (int s = 0; s < numSprings; ++s)
+    // Block peak and where it falls
+    float peak = 0.0f;
+    int peakIndex = 0;
+    const int numInputChannels = monoInput ? 1 : std::min(buffer.getNumChannels(), 2);
+    for (int channel = 0; channel < numInputChannels; ++channel)
     {
-        SpringDelay& spring = springs[s];
-        int bufSize = static_cast<int>(spring.delayLine.size());
-        int apBufSize = static_cast<int>(spring.allpassBuffer.size());
-
-        // Read from delay line
-        int readIndex = spring.writeIndex - spring.delayLength;
-        if (readIndex < 0) readIndex += bufSize;
-
-        float delayed = spring.delayLine[readIndex];
-
-        // Spring characteristic: chirp filter (dispersion)
-        // High frequencies arrive slightly before low frequencies
-        // Implement as cascaded allpass filters with frequency-dependent delay
-        float chirpCoeff = 0.3f + tension * 0.4f;
-
-        // First order allpass for chirp
-        float chirpOut1 = chirpCoeff * (delayed - spring.chirpState1) + spring.delayLine[
-            (readIndex + spring.delayLength / 4) % bufSize];
-        spring.chirpState1 = chirpOut1;
-
-        float chirpOut2 = chirpCoeff * (chirpOut1 - spring.chirpState2) + delayed;
-        spring.chirpState2 = chirpOut2;
-
-        // Blend between chirped and normal based on tension
-        float springOut = delayed * (1.0f - tension * 0.5f) + chirpOut2 * tension * 0.5f;
-
-        // Damping filter
-        spring.filterState = springOut * (1.0f - damping) + spring.filterState * damping;
-
-        // Drip effect: occasional random modulation simulating spring chaos
-        float dripMod = 1.0f;
-        if (drip > 0.0f)
+        const float* data = buffer.getReadPointer(channel);
+        for (int sample = 0; sample < numSamples; ++sample)
         {
-            // Simple drip: randomly modulate feedback occasionally
-            if (random.nextFloat() < drip * 0.001f)
+            float level = std::abs(data[sample]);
+            if (level > peak)
             {
-                dripNoise = random.nextFloat() * 2.0f - 1.0f;
+                peak = level;
+                peakIndex = sample;
             }
-            dripNoise *= 0.995f;  // Decay
-            dripMod = 1.0f + dripNoise * drip * 0.3f;
         }
-
-        // Write new sample with feedback
-        float feedbackSample = spring.filterState * feedback * dripMod;
-        spring.delayLine[spring.writeIndex] = input * (1.0f / numSprings) + feedbackSample;
-
-        spring.writeIndex++;
-        if (spring.writeIndex >= bufSize) spring.writeIndex = 0;
-
-        // Accumulate output with different gains for each spring
-        float springGain = 1.0f - s * 0.2f;  // Slightly reduce gain for secondary springs
-        output += spring.filterState * springGain;
     }
 
-    return output / numSprings;
+    // The envelopes step once per block, so their times are set at block rate
+    const double blockRate = currentSampleRate / numSamples;
+    kickFastEnvelope.setAttack(blockRate, 0.0f);
+    kickFastEnvelope.setRelease(blockRate, 30.0f);
+    kickSlowEnvelope.setAttack(blockRate, 150.0f);
+    kickSlowEnvelope.setRelease(blockRate, 500.0f);
+
+    float fastLevel = kickFastEnvelope.process(peak);
+    float slowLevel = kickSlowEnvelope.process(peak);
+
+    // A transient is a peak well above the recent level; the sharper the
+    // jump, the harder the tank is hit. The peak was found on the dry input,
+    // so the burst waits out the pre-delay as well; the countdown runs on
+    // across blocks, and a hit that comes while one is still waiting is let go.
+    if (kick > 0.0f && kickHoldoff == 0 && kickCountdown < 0 && fastLevel > 0.01f && fastLevel > 2.0f * slowLevel)
+    {
+        float strength = 1.0f - 2.0f * slowLevel / fastLevel;
+        kickPending = kick * strength * peak * 4.0f;
+        kickCountdown = peakIndex + preDelaySamples;
+        kickHoldoff = static_cast<int>(currentSampleRate * 0.08);  // One crash per hit
+    }
 }
 
 void SpringReverb::process(juce::AudioBuffer<float>& buffer)
@@ -256,71 +250,153 @@ void SpringReverb::process(juce::AudioBuffer<float>& buffer)
     if (bypassed)
         return;
 
-    updateParameters();
+    // Quality or spring count switch: the spring state belongs to the old
+    // rate or tank, so the springs fade out, start clean and fade back in
+    springSwapPending = oversamplingRequested != oversampled || springCountRequested != activeTank->getNumSprings();
+    if (springSwapPending && springGain <= 0.0f)
+    {
+        oversampled = oversamplingRequested;
+        applySpringRate();
+        activeTank = getTank(springCountRequested);
+        clearSprings();
+        springSwapPending = false;
+    }
+
+    if (takeParameterChanges())
+    {
+        updateParameters();
+        updateSpringTank();
+    }
+    else
+    {
+        activeTank->beginBlock();
+    }
+    detectTransient(buffer);
 
     auto* leftChannel = buffer.getWritePointer(0);
     auto* rightChannel = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
 
-    int numSamples = buffer.getNumSamples();
+    // Work in chunks no longer than the oversampler was prepared for
+    const int numSamples = buffer.getNumSamples();
+    const int maxChunk = tankBuffer.getNumSamples();
+    for (int start = 0; start < numSamples; start += maxChunk)
+    {
+        int chunkSize = std::min(maxChunk, numSamples - start);
+        processChunk(leftChannel + start, rightChannel ? rightChannel + start : nullptr, chunkSize);
+    }
+
+    loopEnergy.endBlock();
+}
+
+void SpringReverb::processChunk(float* leftChannel, float* rightChannel, int numSamples)
+{
     int preDelayBufSize = static_cast<int>(preDelayBufferL.size());
+    const float* rightInput = monoInput ? nullptr : rightChannel;  // nullptr for a mono source
+    float* tankL = tankBuffer.getWritePointer(0);
+    float* tankR = tankBuffer.getWritePointer(1);
+    float* diffusedL = diffusedBuffer.getWritePointer(0);
+    float* diffusedR = diffusedBuffer.getWritePointer(1);
 
+    // Host rate: input filtering and pre-delay
     for (int sample = 0; sample < numSamples; ++sample)
     {
         float inputL = leftChannel[sample];
-        float inputR = rightChannel ? rightChannel[sample] : inputL;
+        float inputR = rightInput ? rightInput[sample] : inputL;
 
-        // Input filtering
-        inputL = highPassL.process(inputL);
-        inputR = highPassR.process(inputR);
+        // Input filtering, once for a mono source
+        if (rightInput)
+            highPass.process(inputL, inputR);
+        else
+            inputL = highPass.processMono(inputL);
 
         // Pre-delay
         preDelayBufferL[preDelayWriteIndex] = inputL;
-        preDelayBufferR[preDelayWriteIndex] = inputR;
+        if (rightInput)
+            preDelayBufferR[preDelayWriteIndex] = inputR;
 
         int preDelayReadIndex = preDelayWriteIndex - preDelaySamples;
         if (preDelayReadIndex < 0) preDelayReadIndex += preDelayBufSize;
 
-        float delayedL = preDelayBufferL[preDelayReadIndex];
-        float delayedR = preDelayBufferR[preDelayReadIndex];
+        // A mono source splits into left and right at the diffusers
+        diffusedL[sample] = preDelayBufferL[preDelayReadIndex];
+        diffusedR[sample] = rightInput ? preDelayBufferR[preDelayReadIndex] : diffusedL[sample];
 
         preDelayWriteIndex++;
         if (preDelayWriteIndex >= preDelayBufSize) preDelayWriteIndex = 0;
+    }
 
-        // Diffusion (before spring)
-        for (int i = 0; i < numDiffusers; ++i)
+    // Diffusion (before spring), a stage at a time over the chunk
+    diffusers.processBlock(diffusedL, diffusedR, numSamples);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // Kick: an impulse when the detected transient arrives, then a short
+        // rattle. It goes to the springs only, not the diffused blend.
+        float kickL = 0.0f;
+        float kickR = 0.0f;
+        if (kickCountdown >= 0 && kickCountdown-- == 0)
         {
-            delayedL = diffusersL[i].process(delayedL);
-            delayedR = diffusersR[i].process(delayedR);
+            kickL = kickR = kickPending;
+            kickLevel = kickPending;
         }
+        else if (kickLevel > 1.0e-5f)
+        {
+            kickLevel *= kickDecay;
+            kickL = kickLevel * kickNoise.nextBipolar();
+            kickR = kickLevel * kickNoise.nextBipolar();
+        }
+
+        // Input into the springs fades out while frozen
+        float tankInputGain = loopEnergy.getNextInputGain();
+        tankL[sample] = (diffusedL[sample] + kickL) * tankInputGain;
+        tankR[sample] = (diffusedR[sample] + kickR) * tankInputGain;
+        diffusedL[sample] *= tankInputGain;
+        diffusedR[sample] *= tankInputGain;
+    }
+
+    // Spring rate: the spring model runs in place on the tank signal
+    juce::dsp::AudioBlock<float> tankBlock(tankBuffer.getArrayOfWritePointers(), 2, static_cast<size_t>(numSamples));
 
-        // Process through spring model
-        float springOutL = processSpringModel(delayedL, 0);
-        float springOutR = processSpringModel(delayedR, 1);
+    if (oversampled)
+    {
+        auto upsampled = oversampler->processSamplesUp(tankBlock);
+        runSprings(upsampled.getChannelPointer(0), upsampled.getChannelPointer(1),
+                   static_cast<int>(upsampled.getNumSamples()));
+        oversampler->processSamplesDown(tankBlock);
+    }
+    else
+    {
+        runSprings(tankL, tankR, numSamples);
+    }
 
-        // Apply spring low-pass characteristic (springs have limited bandwidth)
-        springOutL = springLPL.process(springOutL);
-        springOutR = springLPR.process(springOutR);
+    // Host rate: spring mix and output filtering
+    const float springTarget = springSwapPending ? 0.0f : 1.0f;
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        springGain = springTarget < springGain ? std::max(springTarget, springGain - springFadeStep)
+                                               : std::min(springTarget, springGain + springFadeStep);
 
         // Blend spring and diffused signal based on springMix
-        float wetL = delayedL * (1.0f - springMix) + springOutL * springMix;
-        float wetR = delayedR * (1.0f - springMix) + springOutR * springMix;
+        const float springLevel = springMix * springGain;
+        float wetL = diffusedL[sample] * (1.0f - springMix) + tankL[sample] * springLevel;
+        float wetR = diffusedR[sample] * (1.0f - springMix) + tankR[sample] * springLevel;
 
         // Output filtering
-        wetL = lowPassL.process(wetL);
-        wetR = lowPassR.process(wetR);
+        lowPass.process(wetL, wetR);
 
-        // Apply width
-        float mid = (wetL + wetR) * 0.5f;
-        float side = (wetL - wetR) * 0.5f;
-        wetL = mid + side * width;
-        wetR = mid - side * width;
+        leftChannel[sample] = wetL;
+        if (rightChannel)
+            rightChannel[sample] = wetR;
+    }
+}
 
-        // Mix
-        float dryL = leftChannel[sample];
-        float dryR = rightChannel ? rightChannel[sample] : dryL;
+void SpringReverb::runSprings(float* tankL, float* tankR, int numSamples)
+{
+    activeTank->process(tankL, tankR, numSamples, loopEnergy);
 
-        leftChannel[sample] = dryL * (1.0f - mix) + wetL * mix;
-        if (rightChannel)
-            rightChannel[sample] = dryR * (1.0f - mix) + wetR * mix;
+    // Apply spring low-pass characteristic (springs have limited bandwidth)
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        springLP.process(tankL[sample], tankR[sample]);
     }
 }
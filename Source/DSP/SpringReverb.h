@@ -3,13 +3,12 @@
 #include <JuceHeader.h>
 #include "ReverbBase.h"
 #include "DSPUtils.h"
+#include "SpringTank.h"
 #include <array>
 
 class SpringReverb : public ReverbBase
 {
 public:
-    SpringReverb();
-
     void prepare(double sampleRate, int samplesPerBlock) override;
     void process(juce::AudioBuffer<float>& buffer) override;
     void reset() override;
@@ -18,45 +17,60 @@ public:
     void setTension(float tensionAmount);    // 0-1, affects pitch/chirp
     void setDrip(float dripAmount);          // 0-1, spring "splatter" effect
     void setSpringMix(float springAmount);   // 0-1, blend of spring character
+    void setKick(float kickAmount);          // 0-1, crash when the input hits hard
+    void setOversampling(bool shouldOversample);  // Run the springs at 2x (cleaner chirps, more CPU)
+    void setSpringCount(int count);          // 2, 3, 4 or 6 springs per channel
 
     float getTension() const { return tension; }
     float getDrip() const { return drip; }
     float getSpringMix() const { return springMix; }
+    float getKick() const { return kick; }
+    bool isOversampling() const { return oversamplingRequested; }
+    int getSpringCount() const { return springCountRequested; }
 
 private:
     void updateParameters();
-    float processSpringModel(float input, int channel);
+    void updateSpringTank();
+    void detectTransient(const juce::AudioBuffer<float>& buffer);
+    void applySpringRate();
+    void clearSprings();
+    void processChunk(float* leftChannel, float* rightChannel, int numSamples);
+    void runSprings(float* tankL, float* tankR, int numSamples);
+    SpringTankBase* getTank(int count);
 
     // Spring-specific parameters
     float tension = 0.5f;    // Affects dispersive delay
     float drip = 0.3f;       // Splatter/chaos amount
     float springMix = 0.7f;  // How much spring character
-
-    // Physical spring model parameters
-    // Springs have dispersive characteristics - high frequencies travel faster
-    static constexpr int numSprings = 3;  // Simulate 3 springs for richness
-
-    // Dispersive delay network for each spring
-    struct SpringDelay
-    {
-        std::vector<float> delayLine;
-        std::vector<float> allpassBuffer;
-        int delayLength = 1000;
-        int writeIndex = 0;
-        int allpassWriteIndex = 0;
-        float filterState = 0.0f;
-        float allpassState = 0.0f;
-
-        // Chirp filter states
-        float chirpState1 = 0.0f;
-        float chirpState2 = 0.0f;
-    };
-
-    std::array<SpringDelay, numSprings> springsL;
-    std::array<SpringDelay, numSprings> springsR;
-
-    // Delay lengths for each spring (create natural beating)
-    const int baseDelayLengths[3] = { 1103, 1327, 1559 };  // Prime-based
+    float kick = 0.0f;       // Transient crash amount
+
+    // Physical spring model: one tank per supported spring count, all
+    // allocated in prepare() so switching between them never allocates.
+    // Springs have dispersive characteristics - high frequencies travel faster.
+    SpringTank<2> tank2;
+    SpringTank<3> tank3;
+    SpringTank<4> tank4;
+    SpringTank<6> tank6;
+    SpringTankBase* activeTank = &tank3;
+    int springCountRequested = 3;
+
+    // Oversampling: pre-delay and diffusers run at host rate, only the spring
+    // model (delays, dispersion, drip, band-limit) runs at springSampleRate
+    bool oversamplingRequested = false;
+    bool oversampled = false;
+    double springSampleRate = 44100.0;
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+
+    // Output gain of the springs, faded out before a quality or spring count
+    // switch clears them and back in afterwards
+    bool springSwapPending = false;
+    float springGain = 1.0f;
+    float springFadeStep = 0.0023f;
+
+    // Host-rate signals for one chunk: tank holds the spring input and then
+    // the spring output, diffused keeps the input for the spring mix
+    juce::AudioBuffer<float> tankBuffer;
+    juce::AudioBuffer<float> diffusedBuffer;
 
     // Pre-delay
     std::vector<float> preDelayBufferL;
@@ -66,20 +80,25 @@ private:
 
     // Tank diffusers (for smoothing)
     static constexpr int numDiffusers = 3;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersL;
-    std::array<DSPUtils::AllpassFilter, numDiffusers> diffusersR;
-
-    // Drip modulation (chaotic LFO)
-    float dripPhase = 0.0f;
-    float dripNoise = 0.0f;
+    DSPUtils::DiffuserBank diffusers;
+
+    // Kick: a real tank crashes when a sharp transient jolts its transducer.
+    // A block-rate detector compares fast and slow envelopes of the input
+    // peak; a jump fires an impulse plus a short noise rattle into the springs
+    // at the peak's position, which the dispersion turns into the "boing".
+    DSPUtils::EnvelopeFollower kickFastEnvelope;
+    DSPUtils::EnvelopeFollower kickSlowEnvelope;
+    DSPUtils::FastNoise kickNoise { 0x6c078965u };
+    float kickPending = 0.0f;     // Level of the scheduled burst
+    int kickCountdown = -1;       // Samples until it fires, -1 while nothing is scheduled
+    int kickHoldoff = 0;          // Samples before another kick may fire
+    float kickLevel = 0.0f;       // Rattle envelope, decays per sample
+    float kickDecay = 0.99f;
 
     // Filters
-    DSPUtils::BiquadFilter highPassL, highPassR;
-    DSPUtils::BiquadFilter lowPassL, lowPassR;
+    DSPUtils::StereoBiquad highPass;
+    DSPUtils::StereoBiquad lowPass;
 
     // One-pole filters for spring response shaping
-    DSPUtils::OnePoleFilter springLPL, springLPR;
-
-    // Random number generator for drip
-    juce::Random random;
+    DSPUtils::StereoOnePole springLP;
 };
@@ -0,0 +1,369 @@
+#pragma once
+
+#include "DSPUtils.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Per-block settings shared by every spring tank variant
+struct SpringTankSettings
+{
+    double sampleRate = 44100.0;  // Rate the springs run at (host rate or oversampled)
+    float tension = 0.5f;
+    float size = 0.5f;
+    float decaySeconds = 2.0f;
+    float loopDamping = 0.5f;     // Per-sample damping pole, already matched to sampleRate
+    float drip = 0.3f;
+    bool freeze = false;
+};
+
+// Common interface so SpringReverb can switch tank variants between blocks.
+// Calls are per block or per chunk, never per sample.
+class SpringTankBase
+{
+public:
+    virtual ~SpringTankBase() = default;
+
+    virtual void prepare(double maxSampleRate) = 0;
+    virtual void reset() = 0;
+    virtual void update(const SpringTankSettings& settings) = 0;
+    // Once per block when the settings have not changed
+    virtual void beginBlock() = 0;
+    virtual void process(float* tankL, float* tankR, int numSamples,
+                         DSPUtils::LoopEnergyControl& loopEnergy) = 0;
+    virtual int getNumSprings() const = 0;
+};
+
+// Stereo tank of NumSprings dispersive springs per channel.
+// All springs of both channels run in lockstep as lanes
+// (lane = channel * NumSprings + spring). Their delay lines share one arena
+// with a common write index, and the per-lane state is kept as
+// structure-of-arrays. Each line is a power of two long, and the lines are
+// padded apart by a cache line so the lanes' writes do not all fall in the
+// same L1 set.
+// Delay lengths are fractional. update() only sets block-rate targets; the
+// read heads glide towards them per sample, and a large jump crossfades
+// from the old head to the new one instead, so size and tension automate
+// without clicks.
+template <int NumSprings>
+class SpringTank : public SpringTankBase
+{
+public:
+    static_assert(NumSprings >= 1 && NumSprings <= 6, "Spring tanks have 1 to 6 springs");
+
+    static constexpr int numLanes = 2 * NumSprings;
+    static constexpr int numCascadeLanes = (numLanes + 3) & ~3;  // Padded to a SIMD-friendly width
+    static constexpr int numDispersionStages = 64;
+
+    // The springs run at up to 384 kHz (192 kHz hosts, oversampled 2x). The
+    // cascade's stretch has to reach that rate's chirp transition.
+    static constexpr float maxSpringRate = 384000.0f;
+    static constexpr float chirpFrequency = 4400.0f;
+    static constexpr int maxDispersionStretch = 64;
+    static_assert(maxDispersionStretch > static_cast<int>(maxSpringRate / (2.0f * chirpFrequency) + 0.5f),
+                  "Dispersion stretch ring too short for the highest spring rate");
+
+    SpringTank()
+    {
+        // Each spring disperses a little less than the one before, so their
+        // chirps do not line up
+        for (int s = 0; s < NumSprings; ++s)
+            dispersionScales[s] = 1.0f - s * 0.08f;
+
+        // No length or tension offsets until the tank is voiced
+        lengthScales.fill(1.0f);
+
+        // Distinct seeds keep the springs' drips uncorrelated
+        for (int lane = 0; lane < numLanes; ++lane)
+            dripNoise[lane].setSeed(0x2545f491u * static_cast<uint32_t>(lane + 1));
+
+        // Secondary springs are slightly quieter
+        for (int lane = 0; lane < numLanes; ++lane)
+            outputGains[lane] = (1.0f - (lane % NumSprings) * (0.6f / NumSprings)) / NumSprings;
+    }
+
+    // Per-spring variation: lengthScale stretches the spring's delay and
+    // tensionOffset is added to the tank's tension for that spring.
+    // Takes effect on the next update().
+    void setSpringOffset(int spring, float lengthScale, float tensionOffset)
+    {
+        lengthScales[spring] = lengthScale;
+        tensionOffsets[spring] = tensionOffset;
+    }
+
+    void prepare(double maxSampleRate) override
+    {
+        int maxDelay = static_cast<int>(maxSampleRate * 0.15);
+        laneStride = 1;
+        while (laneStride < maxDelay)
+            laneStride <<= 1;
+        laneMask = laneStride - 1;
+        laneSpacing = laneStride + lanePadding;
+
+        arena.assign(static_cast<size_t>(laneSpacing) * numLanes, 0.0f);
+        reset();
+    }
+
+    void reset() override
+    {
+        std::fill(arena.begin(), arena.end(), 0.0f);
+        writeIndex = 0;
+        snapDelays = true;
+        filterStates.fill(0.0f);
+        dripLevels.fill(0.0f);
+        dripCountdowns.fill(-1);
+        dispersion.reset();
+    }
+
+    void update(const SpringTankSettings& settings) override
+    {
+        const float sampleRate = static_cast<float>(settings.sampleRate);
+        lastSettings = settings;
+
+        // Stretch the dispersion cascade so its chirp transition sits around
+        // 4.4 kHz whatever the rate
+        dispersion.setStretch(static_cast<int>(std::round(sampleRate / (2.0f * chirpFrequency))));
+
+        // Dispersion strength and loop length follow each spring's tension,
+        // loop lengths also follow size
+        float sizeFactor = 0.5f + settings.size * 1.0f;
+        std::array<float, numLanes> loopLengths;
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const int s = lane % NumSprings;
+            float tension = std::clamp(settings.tension + tensionOffsets[s], 0.0f, 1.0f);
+            dispersion.setCoefficient(lane, -(0.35f + tension * 0.25f) * dispersionScales[s]);
+
+            float tensionFactor = 0.7f + tension * 0.6f;  // Higher tension = shorter delay (higher pitch)
+            float stereoOffset = (lane < NumSprings) ? 1.0f : 1.07f;
+            loopLengths[lane] = baseDelayLengths[s] * lengthScales[s] * stereoOffset * sizeFactor / tensionFactor *
+                                sampleRate / 44100.0f;
+        }
+
+        // The cascade already delays low frequencies, so the delay line only
+        // makes up the rest of the loop. A short, tight spring can be shorter
+        // than the full cascade; it then runs fewer stages so its loop keeps
+        // its length rather than the delay line being held at a minimum.
+        int numStages = numDispersionStages;
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            int fittingStages = static_cast<int>((loopLengths[lane] - minDelayLength) / dispersion.getStageDelayAtDC(lane));
+            numStages = std::min(numStages, std::max(0, fittingStages));
+        }
+        // A new stage count crossfades in over 20 ms, except straight after a reset
+        fadeStep = 1.0f / (0.02f * sampleRate);
+        dispersion.setNumStages(numStages, snapDelays ? 1.0f : fadeStep);
+        stagesPending = dispersion.getNumStages() != numStages;  // Held back by a running fade
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            float length = loopLengths[lane] - dispersion.getGroupDelayAtDC(lane);
+            targetDelays[lane] = std::clamp(length, minDelayLength, static_cast<float>(laneMask - 1));
+
+            if (snapDelays)
+            {
+                currentDelays[lane] = targetDelays[lane];
+                fadePositions[lane] = 1.0f;
+            }
+            else if (fadePositions[lane] >= 1.0f &&
+                     std::abs(targetDelays[lane] - currentDelays[lane]) > currentDelays[lane] * 0.05f)
+            {
+                // Gliding this far would be an audible pitch sweep, so jump
+                // the head and crossfade from where it was
+                fadeFromDelays[lane] = currentDelays[lane];
+                currentDelays[lane] = targetDelays[lane];
+                fadePositions[lane] = 0.0f;
+            }
+        }
+        snapDelays = false;
+
+        // ~30 ms glide for small moves, 20 ms crossfade for large ones
+        delaySmoothing = DSPUtils::calculateCoefficient(sampleRate, 30.0f);
+
+        // Feedback per lane, so every spring decays at the same rate whatever
+        // its loop length
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            if (settings.freeze)
+            {
+                feedbacks[lane] = 1.0f;  // Lossless loop, level held by loopEnergy
+            }
+            else if (settings.decaySeconds >= 30.0f)
+            {
+                feedbacks[lane] = 0.995f;
+            }
+            else
+            {
+                float loopLength = targetDelays[lane] + dispersion.getGroupDelayAtDC(lane);
+                float feedback = std::pow(10.0f, -3.0f * loopLength / (settings.decaySeconds * sampleRate));
+                feedbacks[lane] = std::clamp(feedback, 0.0f, 0.98f);
+            }
+        }
+
+        loopDamping = settings.loopDamping;
+        drip = settings.drip;
+
+        // Per-sample decay of a drip, matched to the 44.1 kHz-era 0.995
+        dripDecay = std::pow(0.995f, 44100.0f / sampleRate);
+        dripInterval = drip > 0.0f ? 0.0227f * sampleRate / drip : 0.0f;
+        scheduleDrips();
+    }
+
+    void beginBlock() override
+    {
+        // A stage count change that had to wait for the previous fade is
+        // applied once that fade is over
+        if (stagesPending && !dispersion.isFading())
+            update(lastSettings);
+        else
+            scheduleDrips();
+    }
+
+    void process(float* tankL, float* tankR, int numSamples,
+                 DSPUtils::LoopEnergyControl& loopEnergy) override
+    {
+        const float inputGain = 1.0f / NumSprings;
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            // Read every spring's delay line into its cascade lane
+            typename Cascade::LaneArray lanes {};
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                currentDelays[lane] += (targetDelays[lane] - currentDelays[lane]) * delaySmoothing;
+                lanes[lane] = readDelay(lane, currentDelays[lane]);
+
+                if (fadePositions[lane] < 1.0f)
+                {
+                    float previous = readDelay(lane, fadeFromDelays[lane]);
+                    lanes[lane] = previous + (lanes[lane] - previous) * fadePositions[lane];
+                    fadePositions[lane] = std::min(1.0f, fadePositions[lane] + fadeStep);
+                }
+            }
+
+            // Spring characteristic: dispersion. Low frequencies arrive after
+            // high ones, and the spread grows on every trip round the loop.
+            dispersion.process(lanes);
+
+            // Damping filter
+            for (int lane = 0; lane < numLanes; ++lane)
+                filterStates[lane] = lanes[lane] * (1.0f - loopDamping) + filterStates[lane] * loopDamping;
+
+            // Drip effect: occasional random modulation simulating spring chaos.
+            // Events were scheduled at block rate; here they only count down.
+            std::array<float, numLanes> dripMods;
+            dripMods.fill(1.0f);
+            if (drip > 0.0f)
+            {
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    if (--dripCountdowns[lane] == 0)
+                    {
+                        dripLevels[lane] = dripNoise[lane].nextBipolar();
+                        dripCountdowns[lane] = -1;
+                    }
+                    dripLevels[lane] *= dripDecay;
+                    dripMods[lane] = 1.0f + dripLevels[lane] * drip * 0.3f;
+                }
+            }
+
+            // Write new samples with feedback and accumulate the outputs
+            float outputL = 0.0f;
+            float outputR = 0.0f;
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const bool left = lane < NumSprings;
+                float input = (left ? tankL[sample] : tankR[sample]) * inputGain;
+                float feedbackSample = loopEnergy.process(filterStates[lane] * feedbacks[lane] * dripMods[lane]);
+                arena[lane * laneSpacing + writeIndex] = input + feedbackSample;
+
+                (left ? outputL : outputR) += filterStates[lane] * outputGains[lane];
+            }
+
+            writeIndex = (writeIndex + 1) & laneMask;
+
+            tankL[sample] = outputL;
+            tankR[sample] = outputR;
+        }
+    }
+
+    int getNumSprings() const override { return NumSprings; }
+
+private:
+    // Linearly interpolated read, delay in samples behind the write index
+    float readDelay(int lane, float delay) const
+    {
+        const int whole = static_cast<int>(delay);
+        const float frac = delay - static_cast<float>(whole);
+        const float* line = arena.data() + lane * laneSpacing;
+        float a = line[(writeIndex - whole) & laneMask];
+        float b = line[(writeIndex - whole - 1) & laneMask];
+        return a + (b - a) * frac;
+    }
+
+    void scheduleDrips()
+    {
+        if (drip <= 0.0f)
+        {
+            dripCountdowns.fill(-1);
+            return;
+        }
+
+        // Drips form a Poisson process, on average one per ~23 ms per spring at
+        // full drip. A lane whose event has fired gets its next one drawn here.
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            if (dripCountdowns[lane] > 0)
+                continue;
+
+            float interval = -std::log(1.0f - dripNoise[lane].nextFloat()) * dripInterval;
+            dripCountdowns[lane] = 1 + static_cast<int>(std::min(interval, 1.0e8f));
+        }
+    }
+
+    using Cascade = DSPUtils::StretchedAllpassCascade<numCascadeLanes, numDispersionStages, maxDispersionStretch>;
+
+    // Prime-based lengths (at 44.1 kHz) so the springs beat against each other
+    static constexpr float baseDelayLengths[6] = { 1103.0f, 1327.0f, 1559.0f, 1787.0f, 2029.0f, 2311.0f };
+
+    // Shortest delay line left once the cascade's share of the loop is taken out
+    static constexpr float minDelayLength = 100.0f;
+
+    // Delay arena: lane-major, laneStride samples per lane, lines laneSpacing apart
+    static constexpr int lanePadding = 16;  // One 64-byte cache line
+    std::vector<float> arena;
+    int laneStride = 1;
+    int laneSpacing = 1;
+    int laneMask = 0;
+    int writeIndex = 0;
+
+    Cascade dispersion;
+
+    // Per-spring offsets
+    std::array<float, NumSprings> lengthScales {};
+    std::array<float, NumSprings> tensionOffsets {};
+    std::array<float, NumSprings> dispersionScales {};  // How strongly tension disperses each spring
+
+    // Per-lane state
+    std::array<float, numLanes> targetDelays {};    // Set per block
+    std::array<float, numLanes> currentDelays {};   // Glides per sample
+    std::array<float, numLanes> fadeFromDelays {};  // Old head during a crossfade
+    std::array<float, numLanes> fadePositions {};   // 0-1, 1 when no crossfade is running
+    std::array<float, numLanes> feedbacks {};
+    std::array<float, numLanes> filterStates {};
+    std::array<float, numLanes> outputGains {};
+    std::array<float, numLanes> dripLevels {};
+    std::array<int, numLanes> dripCountdowns {};
+    std::array<DSPUtils::FastNoise, numLanes> dripNoise;
+
+    SpringTankSettings lastSettings;
+    bool stagesPending = false;
+    bool snapDelays = true;  // Jump straight to the targets after a reset
+    float delaySmoothing = 1.0f;
+    float fadeStep = 1.0f;
+
+    float loopDamping = 0.0f;
+    float drip = 0.0f;
+    float dripDecay = 0.995f;
+    float dripInterval = 0.0f;  // Mean samples between drips per spring
+};
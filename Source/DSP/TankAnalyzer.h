@@ -0,0 +1,137 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+
+// Spectrum tap for a reverb feedback loop.
+// The audio thread pushes loop samples; every hop a windowed FFT is reduced to
+// log-spaced band magnitudes and queued in a single-producer/single-consumer
+// FIFO for the editor. Nothing is allocated after construction.
+class TankAnalyzer
+{
+public:
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+    static constexpr int numBands = 64;
+    static constexpr int fifoFrames = 32;
+
+    using Frame = std::array<float, numBands>;
+
+    TankAnalyzer()
+    {
+        for (int i = 0; i < fftSize; ++i)
+            window[i] = 0.5f - 0.5f * std::cos(6.283185307179586f * i / fftSize);
+    }
+
+    void prepare(double sampleRate)
+    {
+        // Decimate to roughly 24 kHz so the bands cover the audible range
+        // without spending bins on content the tank has already damped
+        decimation = std::max(1, static_cast<int>(std::round(sampleRate / 24000.0)));
+        float binWidth = static_cast<float>(sampleRate / decimation) / fftSize;
+
+        const float lowestHz = 40.0f;
+        const float highestHz = static_cast<float>(sampleRate / decimation) * 0.5f;
+        for (int b = 0; b <= numBands; ++b)
+        {
+            float hz = lowestHz * std::pow(highestHz / lowestHz, static_cast<float>(b) / numBands);
+            bandEdges[b] = std::clamp(static_cast<int>(hz / binWidth), 1, fftSize / 2);
+        }
+
+        for (int b = 0; b < numBands; ++b)
+            bandEdges[b + 1] = std::max(bandEdges[b + 1], bandEdges[b] + 1);
+
+        reset();
+    }
+
+    void reset()
+    {
+        history.fill(0.0f);
+        historyIndex = 0;
+        hopCounter = 0;
+        decimationAccum = 0.0f;
+        decimationCounter = 0;
+    }
+
+    // Editor side: the tap costs nothing unless someone is looking at it
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+
+    // Audio side: sample the flag once per block
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void pushSample(float sample)
+    {
+        decimationAccum += sample;
+        if (++decimationCounter < decimation)
+            return;
+
+        history[historyIndex] = decimationAccum / decimation;
+        historyIndex = (historyIndex + 1) & (fftSize - 1);
+        decimationAccum = 0.0f;
+        decimationCounter = 0;
+
+        if (++hopCounter >= hopSize)
+        {
+            hopCounter = 0;
+            analyseFrame();
+        }
+    }
+
+    // Editor side: returns false once the FIFO is drained
+    bool pullFrame(Frame& frame)
+    {
+        const auto scope = fifo.read(1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        frame = frames[scope.startIndex1];
+        return true;
+    }
+
+private:
+    void analyseFrame()
+    {
+        // Unwrap the history so the oldest sample lands first
+        for (int i = 0; i < fftSize; ++i)
+            fftData[i] = history[(historyIndex + i) & (fftSize - 1)] * window[i];
+
+        std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+        // A full-scale sine through the Hann window peaks at fftSize / 4
+        const float scale = 4.0f / fftSize;
+
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 == 0)
+            return;  // Editor is behind; drop the frame rather than block
+
+        Frame& frame = frames[scope.startIndex1];
+        for (int b = 0; b < numBands; ++b)
+        {
+            float peak = 0.0f;
+            for (int bin = bandEdges[b]; bin < bandEdges[b + 1]; ++bin)
+                peak = std::max(peak, fftData[bin]);
+            frame[b] = peak * scale;
+        }
+    }
+
+    juce::dsp::FFT fft { fftOrder };
+    std::array<float, fftSize> window;
+    std::array<float, fftSize * 2> fftData {};
+    std::array<float, fftSize> history {};
+    std::array<int, numBands + 1> bandEdges {};
+
+    int historyIndex = 0;
+    int hopCounter = 0;
+    int decimation = 1;
+    int decimationCounter = 0;
+    float decimationAccum = 0.0f;
+
+    juce::AbstractFifo fifo { fifoFrames };
+    std::array<Frame, fifoFrames> frames {};
+
+    std::atomic<bool> enabled { false };
+};
@@ -9,9 +9,17 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
 
     // Type selector
     setupComboBox(typeSelector, typeLabel, "TYPE",
-                  juce::StringArray{ "Algorithmic", "Shimmer", "Spring", "Gated" });
+                  juce::StringArray{ "Algorithmic", "Shimmer", "Spring", "Gated", "Plate", "Reverse" });
     typeSelector.onChange = [this]() { updateVisibleControls(); };
 
+    // Type switch: crossfade or ring out, and how long it takes
+    setupComboBox(switchModeSelector, switchModeLabel, "",
+                  juce::StringArray{ "Crossfade", "Ring Out" });
+    switchTimeSlider.setSliderStyle(juce::Slider::LinearBar);
+    switchTimeSlider.setTextValueSuffix(" ms");
+    switchTimeSlider.setColour(juce::Slider::textBoxTextColourId, Colors::textPrimary);
+    addAndMakeVisible(switchTimeSlider);
+
     // Algo mode selector
     setupComboBox(algoModeSelector, algoModeLabel, "MODE",
                   juce::StringArray{ "Room", "Hall", "Plate", "Chamber" });
@@ -31,6 +39,8 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
     setupSlider(dampingSlider, dampingLabel, "DAMPING");
     setupSlider(sizeSlider, sizeLabel, "SIZE");
     setupSlider(diffusionSlider, diffusionLabel, "DIFFUSION");
+    setupComboBox(diffuserTypeSelector, diffuserTypeLabel, "DIFFUSER",
+                  juce::StringArray{ "Classic", "Nested", "Modulated" });
 
     setupSlider(modRateSlider, modRateLabel, "MOD RATE");
     setupSlider(modDepthSlider, modDepthLabel, "MOD DEPTH");
@@ -42,22 +52,55 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
     setupSlider(duckingSlider, duckingLabel, "DUCKING");
     setupSlider(mixSlider, mixLabel, "MIX");
 
+    // Sidechain key
+    setupComboBox(sidechainTargetSelector, sidechainTargetLabel, "SIDECHAIN",
+                  juce::StringArray{ "Off", "Gate", "Ducker", "Gate + Ducker" });
+    setupSlider(sidechainHighPassSlider, sidechainHighPassLabel, "KEY HPF");
+    setupSlider(sidechainLowPassSlider, sidechainLowPassLabel, "KEY LPF");
+
+    // Ducker
+    setupSlider(duckThresholdSlider, duckThresholdLabel, "THRESHOLD");
+    setupSlider(duckRatioSlider, duckRatioLabel, "RATIO");
+    setupSlider(duckAttackSlider, duckAttackLabel, "ATTACK");
+    setupSlider(duckReleaseSlider, duckReleaseLabel, "RELEASE");
+    setupComboBox(duckDetectionSelector, duckDetectionLabel, "DETECT",
+                  juce::StringArray{ "Peak", "RMS" });
+
     // Shimmer controls
     setupSlider(shimmerAmountSlider, shimmerAmountLabel, "SHIMMER");
+    setupSlider(shimmerSaturationSlider, shimmerSaturationLabel, "SATURATE");
 
     shimmerInfiniteButton.setButtonText("Infinite");
     addAndMakeVisible(shimmerInfiniteButton);
 
+    shimmerFormantButton.setButtonText("Formant");
+    addAndMakeVisible(shimmerFormantButton);
+
     // Spring controls
     setupSlider(springTensionSlider, springTensionLabel, "TENSION");
     setupSlider(springDripSlider, springDripLabel, "DRIP");
     setupSlider(springMixSlider, springMixLabel, "SPRING MIX");
+    setupSlider(springKickSlider, springKickLabel, "KICK");
+    setupComboBox(springQualitySelector, springQualityLabel, "QUALITY",
+                  juce::StringArray{ "Standard", "High (2x)" });
+    setupComboBox(springCountSelector, springCountLabel, "SPRINGS",
+                  juce::StringArray{ "2", "3", "4", "6" });
 
     // Gated controls
     setupSlider(gateThresholdSlider, gateThresholdLabel, "THRESHOLD");
+    setupSlider(gateAttackSlider, gateAttackLabel, "ATTACK");
     setupSlider(gateHoldSlider, gateHoldLabel, "HOLD");
     setupSlider(gateReleaseSlider, gateReleaseLabel, "RELEASE");
     setupSlider(gateShapeSlider, gateShapeLabel, "SHAPE");
+    setupSlider(gateLookaheadSlider, gateLookaheadLabel, "LOOKAHEAD");
+    setupComboBox(gateCurveSelector, gateCurveLabel, "CURVE",
+                  juce::StringArray{ "Shaped", "Linear", "Exponential", "Nonlinear" });
+    setupComboBox(gateRetriggerSelector, gateRetriggerLabel, "RETRIGGER",
+                  juce::StringArray{ "Legato", "Restart", "Ignore" });
+
+    // Reverse controls
+    setupSlider(reverseLengthSlider, reverseLengthLabel, "LENGTH");
+    setupSlider(reverseRiseSlider, reverseRiseLabel, "RISE");
 
     // Tempo sync button
     preDelayTempoSyncButton.setButtonText("Sync");
@@ -81,16 +124,31 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
     addAndMakeVisible(outputMeter);
     addAndMakeVisible(gateMeter);
     addAndMakeVisible(decayVisualizer);
+    addChildComponent(tankSpectrogram);
 
     // Create APVTS attachments
     typeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getAPVTS(), "reverbType", typeSelector);
+    switchModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "switchMode", switchModeSelector);
+    switchTimeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "switchTime", switchTimeSlider);
     algoModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getAPVTS(), "algoMode", algoModeSelector);
     shimmerPitchAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getAPVTS(), "shimmerPitch", shimmerPitchSelector);
+    springQualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "springQuality", springQualitySelector);
+    springCountAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "springCount", springCountSelector);
     preDelaySyncDivAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getAPVTS(), "preDelaySyncDiv", preDelaySyncDivSelector);
+    diffuserTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "diffuserType", diffuserTypeSelector);
+    sidechainTargetAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "sidechainTarget", sidechainTargetSelector);
+    duckDetectionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "duckDetection", duckDetectionSelector);
 
     preDelayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "preDelay", preDelaySlider);
@@ -120,11 +178,27 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
         audioProcessor.getAPVTS(), "ducking", duckingSlider);
     mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "mix", mixSlider);
+    sidechainHighPassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "sidechainHighPass", sidechainHighPassSlider);
+    sidechainLowPassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "sidechainLowPass", sidechainLowPassSlider);
+    duckThresholdAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "duckThreshold", duckThresholdSlider);
+    duckRatioAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "duckRatio", duckRatioSlider);
+    duckAttackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "duckAttack", duckAttackSlider);
+    duckReleaseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "duckRelease", duckReleaseSlider);
 
     shimmerAmountAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "shimmerAmount", shimmerAmountSlider);
+    shimmerSaturationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "shimmerSaturation", shimmerSaturationSlider);
     shimmerInfiniteAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         audioProcessor.getAPVTS(), "shimmerInfinite", shimmerInfiniteButton);
+    shimmerFormantAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getAPVTS(), "shimmerFormant", shimmerFormantButton);
 
     springTensionAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "springTension", springTensionSlider);
@@ -132,15 +206,30 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
         audioProcessor.getAPVTS(), "springDrip", springDripSlider);
     springMixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "springMix", springMixSlider);
+    springKickAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "springKick", springKickSlider);
 
     gateThresholdAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "gateThreshold", gateThresholdSlider);
+    gateAttackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "gateAttack", gateAttackSlider);
     gateHoldAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "gateHold", gateHoldSlider);
     gateReleaseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "gateRelease", gateReleaseSlider);
     gateShapeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.getAPVTS(), "gateShape", gateShapeSlider);
+    gateLookaheadAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "gateLookahead", gateLookaheadSlider);
+    gateCurveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "gateCurve", gateCurveSelector);
+    gateRetriggerAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getAPVTS(), "gateRetrigger", gateRetriggerSelector);
+
+    reverseLengthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "reverseLength", reverseLengthSlider);
+    reverseRiseAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getAPVTS(), "reverseRise", reverseRiseSlider);
 
     freezeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         audioProcessor.getAPVTS(), "freeze", freezeButton);
@@ -159,6 +248,7 @@ DynoverbAudioProcessorEditor::DynoverbAudioProcessorEditor(DynoverbAudioProcesso
 DynoverbAudioProcessorEditor::~DynoverbAudioProcessorEditor()
 {
     stopTimer();
+    audioProcessor.getShimmerTankAnalyzer().setEnabled(false);
     setLookAndFeel(nullptr);
 }
 
@@ -205,7 +295,11 @@ void DynoverbAudioProcessorEditor::updateVisibleControls()
     shimmerPitchLabel.setVisible(false);
     shimmerAmountSlider.setVisible(false);
     shimmerAmountLabel.setVisible(false);
+    shimmerSaturationSlider.setVisible(false);
+    shimmerSaturationLabel.setVisible(false);
     shimmerInfiniteButton.setVisible(false);
+    shimmerFormantButton.setVisible(false);
+    tankSpectrogram.setVisible(false);
 
     springTensionSlider.setVisible(false);
     springTensionLabel.setVisible(false);
@@ -213,18 +307,37 @@ void DynoverbAudioProcessorEditor::updateVisibleControls()
     springDripLabel.setVisible(false);
     springMixSlider.setVisible(false);
     springMixLabel.setVisible(false);
+    springKickSlider.setVisible(false);
+    springKickLabel.setVisible(false);
+    springQualitySelector.setVisible(false);
+    springQualityLabel.setVisible(false);
+    springCountSelector.setVisible(false);
+    springCountLabel.setVisible(false);
 
     gateThresholdSlider.setVisible(false);
     gateThresholdLabel.setVisible(false);
+    gateAttackSlider.setVisible(false);
+    gateAttackLabel.setVisible(false);
     gateHoldSlider.setVisible(false);
     gateHoldLabel.setVisible(false);
     gateReleaseSlider.setVisible(false);
     gateReleaseLabel.setVisible(false);
     gateShapeSlider.setVisible(false);
     gateShapeLabel.setVisible(false);
+    gateLookaheadSlider.setVisible(false);
+    gateLookaheadLabel.setVisible(false);
+    gateCurveSelector.setVisible(false);
+    gateCurveLabel.setVisible(false);
+    gateRetriggerSelector.setVisible(false);
+    gateRetriggerLabel.setVisible(false);
 
     gateMeter.setVisible(false);
 
+    reverseLengthSlider.setVisible(false);
+    reverseLengthLabel.setVisible(false);
+    reverseRiseSlider.setVisible(false);
+    reverseRiseLabel.setVisible(false);
+
     // Show relevant controls
     switch (type)
     {
@@ -238,7 +351,11 @@ void DynoverbAudioProcessorEditor::updateVisibleControls()
             shimmerPitchLabel.setVisible(true);
             shimmerAmountSlider.setVisible(true);
             shimmerAmountLabel.setVisible(true);
+            shimmerSaturationSlider.setVisible(true);
+            shimmerSaturationLabel.setVisible(true);
             shimmerInfiniteButton.setVisible(true);
+            shimmerFormantButton.setVisible(true);
+            tankSpectrogram.setVisible(true);
             break;
 
         case ReverbType::Spring:
@@ -248,21 +365,53 @@ void DynoverbAudioProcessorEditor::updateVisibleControls()
             springDripLabel.setVisible(true);
             springMixSlider.setVisible(true);
             springMixLabel.setVisible(true);
+            springKickSlider.setVisible(true);
+            springKickLabel.setVisible(true);
+            springQualitySelector.setVisible(true);
+            springQualityLabel.setVisible(true);
+            springCountSelector.setVisible(true);
+            springCountLabel.setVisible(true);
             break;
 
         case ReverbType::Gated:
             gateThresholdSlider.setVisible(true);
             gateThresholdLabel.setVisible(true);
+            gateAttackSlider.setVisible(true);
+            gateAttackLabel.setVisible(true);
             gateHoldSlider.setVisible(true);
             gateHoldLabel.setVisible(true);
             gateReleaseSlider.setVisible(true);
             gateReleaseLabel.setVisible(true);
             gateShapeSlider.setVisible(true);
             gateShapeLabel.setVisible(true);
+            gateLookaheadSlider.setVisible(true);
+            gateLookaheadLabel.setVisible(true);
+            gateCurveSelector.setVisible(true);
+            gateCurveLabel.setVisible(true);
+            gateRetriggerSelector.setVisible(true);
+            gateRetriggerLabel.setVisible(true);
             gateMeter.setVisible(true);
             break;
+
+        case ReverbType::Plate:
+            // Plate uses the global controls only
+            break;
+
+        case ReverbType::Reverse:
+            reverseLengthSlider.setVisible(true);
+            reverseLengthLabel.setVisible(true);
+            reverseRiseSlider.setVisible(true);
+            reverseRiseLabel.setVisible(true);
+            break;
     }
 
+    // Only run the tank analyzer while its view is on screen, and start the
+    // view from a blank history when it comes back
+    auto& tankAnalyzer = audioProcessor.getShimmerTankAnalyzer();
+    if (type == ReverbType::Shimmer && !tankAnalyzer.isEnabled())
+        tankSpectrogram.clear();
+    tankAnalyzer.setEnabled(type == ReverbType::Shimmer);
+
     repaint();
 }
 
@@ -327,6 +476,9 @@ void DynoverbAudioProcessorEditor::resized()
     bypassButton.setBounds(headerArea.removeFromRight(80).reduced(5, 15));
     freezeButton.setBounds(headerArea.removeFromRight(80).reduced(5, 15));
 
+    switchTimeSlider.setBounds(headerArea.removeFromRight(80).reduced(5, 15));
+    switchModeSelector.setBounds(headerArea.removeFromRight(110).reduced(5, 15));
+
     bounds.removeFromTop(10);
 
     // Main controls panel
@@ -392,6 +544,10 @@ void DynoverbAudioProcessorEditor::resized()
     lowPassLabel.setBounds(lowPassArea.removeFromTop(labelHeight));
     lowPassSlider.setBounds(lowPassArea);
 
+    auto diffuserTypeArea = row2.removeFromLeft(110).reduced(5, 0);
+    diffuserTypeLabel.setBounds(diffuserTypeArea.removeFromTop(labelHeight));
+    diffuserTypeSelector.setBounds(diffuserTypeArea.removeFromTop(25));
+
     bounds.removeFromTop(10);
 
     // Type-specific panel
@@ -408,7 +564,13 @@ void DynoverbAudioProcessorEditor::resized()
     auto shimmerKnobArea = typePanel.withX(typePanel.getX() + 110).withWidth(knobWidth);
     shimmerAmountLabel.setBounds(shimmerKnobArea.removeFromTop(labelHeight));
     shimmerAmountSlider.setBounds(shimmerKnobArea.removeFromTop(knobHeight));
-    shimmerInfiniteButton.setBounds(typePanel.getX() + 190, typePanel.getY() + 20, 80, 25);
+
+    auto saturationArea = typePanel.withX(typePanel.getX() + 180).withWidth(knobWidth);
+    shimmerSaturationLabel.setBounds(saturationArea.removeFromTop(labelHeight));
+    shimmerSaturationSlider.setBounds(saturationArea.removeFromTop(knobHeight));
+    shimmerInfiniteButton.setBounds(typePanel.getX() + 260, typePanel.getY() + 10, 80, 25);
+    shimmerFormantButton.setBounds(typePanel.getX() + 260, typePanel.getY() + 40, 80, 25);
+    tankSpectrogram.setBounds(typePanel.getX() + 350, typePanel.getY(), 300, typePanel.getHeight());
 
     // Spring controls
     auto springArea = typePanel;
@@ -424,12 +586,27 @@ void DynoverbAudioProcessorEditor::resized()
     springMixLabel.setBounds(sMixArea.removeFromTop(labelHeight));
     springMixSlider.setBounds(sMixArea.removeFromTop(knobHeight));
 
+    auto kickArea = springArea.removeFromLeft(knobWidth);
+    springKickLabel.setBounds(kickArea.removeFromTop(labelHeight));
+    springKickSlider.setBounds(kickArea.removeFromTop(knobHeight));
+
+    auto qualityArea = springArea.removeFromLeft(110).reduced(5, 0);
+    springQualityLabel.setBounds(qualityArea.removeFromTop(labelHeight));
+    springQualitySelector.setBounds(qualityArea.removeFromTop(25));
+    qualityArea.removeFromTop(5);
+    springCountLabel.setBounds(qualityArea.removeFromTop(labelHeight));
+    springCountSelector.setBounds(qualityArea.removeFromTop(25));
+
     // Gated controls
     auto gatedArea = typePanel;
     auto threshArea = gatedArea.removeFromLeft(knobWidth);
     gateThresholdLabel.setBounds(threshArea.removeFromTop(labelHeight));
     gateThresholdSlider.setBounds(threshArea.removeFromTop(knobHeight));
 
+    auto attackArea = gatedArea.removeFromLeft(knobWidth);
+    gateAttackLabel.setBounds(attackArea.removeFromTop(labelHeight));
+    gateAttackSlider.setBounds(attackArea.removeFromTop(knobHeight));
+
     auto holdArea = gatedArea.removeFromLeft(knobWidth);
     gateHoldLabel.setBounds(holdArea.removeFromTop(labelHeight));
     gateHoldSlider.setBounds(holdArea.removeFromTop(knobHeight));
@@ -442,8 +619,29 @@ void DynoverbAudioProcessorEditor::resized()
     gateShapeLabel.setBounds(shapeArea.removeFromTop(labelHeight));
     gateShapeSlider.setBounds(shapeArea.removeFromTop(knobHeight));
 
+    auto lookaheadArea = gatedArea.removeFromLeft(knobWidth);
+    gateLookaheadLabel.setBounds(lookaheadArea.removeFromTop(labelHeight));
+    gateLookaheadSlider.setBounds(lookaheadArea.removeFromTop(knobHeight));
+
+    auto curveArea = gatedArea.removeFromLeft(110).reduced(5, 0);
+    gateCurveLabel.setBounds(curveArea.removeFromTop(labelHeight));
+    gateCurveSelector.setBounds(curveArea.removeFromTop(25));
+    curveArea.removeFromTop(5);
+    gateRetriggerLabel.setBounds(curveArea.removeFromTop(labelHeight));
+    gateRetriggerSelector.setBounds(curveArea.removeFromTop(25));
+
     gateMeter.setBounds(gatedArea.removeFromLeft(150).reduced(10, 25));
 
+    // Reverse controls
+    auto reverseArea = typePanel;
+    auto lengthArea = reverseArea.removeFromLeft(knobWidth);
+    reverseLengthLabel.setBounds(lengthArea.removeFromTop(labelHeight));
+    reverseLengthSlider.setBounds(lengthArea.removeFromTop(knobHeight));
+
+    auto riseArea = reverseArea.removeFromLeft(knobWidth);
+    reverseRiseLabel.setBounds(riseArea.removeFromTop(labelHeight));
+    reverseRiseSlider.setBounds(riseArea.removeFromTop(knobHeight));
+
     bounds.removeFromTop(10);
 
     // Output panel
@@ -453,14 +651,49 @@ void DynoverbAudioProcessorEditor::resized()
     inputMeter.setBounds(outputPanel.getX() + 5, outputPanel.getY() + 15, 15, 70);
     outputMeter.setBounds(outputPanel.getX() + 30, outputPanel.getY() + 15, 15, 70);
 
-    // Output controls
-    auto duckingArea = outputPanel.withX(outputPanel.getX() + 70).withWidth(knobWidth);
+    // Output controls, left to right after the meters
+    auto outputControls = outputPanel.withTrimmedLeft(65);
+    auto duckingArea = outputControls.removeFromLeft(knobWidth);
     duckingLabel.setBounds(duckingArea.removeFromTop(labelHeight));
     duckingSlider.setBounds(duckingArea.removeFromTop(knobHeight));
 
-    auto mixArea = outputPanel.withX(outputPanel.getX() + 150).withWidth(knobWidth);
+    auto mixArea = outputControls.removeFromLeft(knobWidth);
     mixLabel.setBounds(mixArea.removeFromTop(labelHeight));
     mixSlider.setBounds(mixArea.removeFromTop(knobHeight));
+
+    // Sidechain key
+    auto sidechainArea = outputControls.removeFromLeft(120).reduced(5, 0);
+    sidechainTargetLabel.setBounds(sidechainArea.removeFromTop(labelHeight));
+    sidechainTargetSelector.setBounds(sidechainArea.removeFromTop(25));
+    sidechainArea.removeFromTop(5);
+    duckDetectionLabel.setBounds(sidechainArea.removeFromTop(labelHeight));
+    duckDetectionSelector.setBounds(sidechainArea.removeFromTop(25));
+
+    auto keyHighPassArea = outputControls.removeFromLeft(knobWidth);
+    sidechainHighPassLabel.setBounds(keyHighPassArea.removeFromTop(labelHeight));
+    sidechainHighPassSlider.setBounds(keyHighPassArea.removeFromTop(knobHeight));
+
+    auto keyLowPassArea = outputControls.removeFromLeft(knobWidth);
+    sidechainLowPassLabel.setBounds(keyLowPassArea.removeFromTop(labelHeight));
+    sidechainLowPassSlider.setBounds(keyLowPassArea.removeFromTop(knobHeight));
+
+    // Ducker, against the right edge of the panel
+    auto duckerArea = outputControls.removeFromRight(knobWidth * 4);
+    auto duckThresholdArea = duckerArea.removeFromLeft(knobWidth);
+    duckThresholdLabel.setBounds(duckThresholdArea.removeFromTop(labelHeight));
+    duckThresholdSlider.setBounds(duckThresholdArea.removeFromTop(knobHeight));
+
+    auto duckRatioArea = duckerArea.removeFromLeft(knobWidth);
+    duckRatioLabel.setBounds(duckRatioArea.removeFromTop(labelHeight));
+    duckRatioSlider.setBounds(duckRatioArea.removeFromTop(knobHeight));
+
+    auto duckAttackArea = duckerArea.removeFromLeft(knobWidth);
+    duckAttackLabel.setBounds(duckAttackArea.removeFromTop(labelHeight));
+    duckAttackSlider.setBounds(duckAttackArea.removeFromTop(knobHeight));
+
+    auto duckReleaseArea = duckerArea.removeFromLeft(knobWidth);
+    duckReleaseLabel.setBounds(duckReleaseArea.removeFromTop(labelHeight));
+    duckReleaseSlider.setBounds(duckReleaseArea.removeFromTop(knobHeight));
 }
 
 void DynoverbAudioProcessorEditor::timerCallback()
@@ -487,6 +720,21 @@ void DynoverbAudioProcessorEditor::timerCallback()
         gateMeter.setGateLevel(audioProcessor.getGateLevel());
     }
 
+    // Drain shimmer tank spectrum frames into the spectrogram
+    if (tankSpectrogram.isVisible())
+    {
+        TankAnalyzer::Frame frame;
+        bool gotFrame = false;
+        while (audioProcessor.getShimmerTankAnalyzer().pullFrame(frame))
+        {
+            tankSpectrogram.pushFrame(frame.data(), TankAnalyzer::numBands);
+            gotFrame = true;
+        }
+
+        if (gotFrame)
+            tankSpectrogram.repaint();
+    }
+
     // Update decay visualizer
     auto* decayParam = audioProcessor.getAPVTS().getRawParameterValue("decay");
     auto* freezeParam = audioProcessor.getAPVTS().getRawParameterValue("freeze");
@@ -25,6 +25,11 @@ private:
     juce::ComboBox typeSelector;
     juce::Label typeLabel;
 
+    // Type switch mode and time
+    juce::ComboBox switchModeSelector;
+    juce::Label switchModeLabel;
+    juce::Slider switchTimeSlider;
+
     // Type-specific selectors
     juce::ComboBox algoModeSelector;
     juce::Label algoModeLabel;
@@ -49,6 +54,8 @@ private:
 
     juce::Slider diffusionSlider;
     juce::Label diffusionLabel;
+    juce::ComboBox diffuserTypeSelector;
+    juce::Label diffuserTypeLabel;
 
     // Global controls - second row
     juce::Slider modRateSlider;
@@ -77,10 +84,33 @@ private:
     juce::Slider mixSlider;
     juce::Label mixLabel;
 
+    // Sidechain key
+    juce::ComboBox sidechainTargetSelector;
+    juce::Label sidechainTargetLabel;
+    juce::Slider sidechainHighPassSlider;
+    juce::Label sidechainHighPassLabel;
+    juce::Slider sidechainLowPassSlider;
+    juce::Label sidechainLowPassLabel;
+
+    // Ducker
+    juce::Slider duckThresholdSlider;
+    juce::Label duckThresholdLabel;
+    juce::Slider duckRatioSlider;
+    juce::Label duckRatioLabel;
+    juce::Slider duckAttackSlider;
+    juce::Label duckAttackLabel;
+    juce::Slider duckReleaseSlider;
+    juce::Label duckReleaseLabel;
+    juce::ComboBox duckDetectionSelector;
+    juce::Label duckDetectionLabel;
+
     // Type-specific controls - Shimmer
     juce::Slider shimmerAmountSlider;
     juce::Label shimmerAmountLabel;
+    juce::Slider shimmerSaturationSlider;
+    juce::Label shimmerSaturationLabel;
     juce::ToggleButton shimmerInfiniteButton;
+    juce::ToggleButton shimmerFormantButton;
 
     // Type-specific controls - Spring
     juce::Slider springTensionSlider;
@@ -89,16 +119,36 @@ private:
     juce::Label springDripLabel;
     juce::Slider springMixSlider;
     juce::Label springMixLabel;
+    juce::Slider springKickSlider;
+    juce::Label springKickLabel;
+    juce::ComboBox springQualitySelector;
+    juce::Label springQualityLabel;
+    juce::ComboBox springCountSelector;
+    juce::Label springCountLabel;
 
     // Type-specific controls - Gated
     juce::Slider gateThresholdSlider;
     juce::Label gateThresholdLabel;
+    juce::Slider gateAttackSlider;
+    juce::Label gateAttackLabel;
     juce::Slider gateHoldSlider;
     juce::Label gateHoldLabel;
     juce::Slider gateReleaseSlider;
     juce::Label gateReleaseLabel;
     juce::Slider gateShapeSlider;
     juce::Label gateShapeLabel;
+    juce::Slider gateLookaheadSlider;
+    juce::Label gateLookaheadLabel;
+    juce::ComboBox gateCurveSelector;
+    juce::Label gateCurveLabel;
+    juce::ComboBox gateRetriggerSelector;
+    juce::Label gateRetriggerLabel;
+
+    // Type-specific controls - Reverse
+    juce::Slider reverseLengthSlider;
+    juce::Label reverseLengthLabel;
+    juce::Slider reverseRiseSlider;
+    juce::Label reverseRiseLabel;
 
     // Buttons
     juce::ToggleButton freezeButton;
@@ -109,6 +159,7 @@ private:
     LevelMeter outputMeter;
     GateMeter gateMeter;
     DecayVisualizer decayVisualizer;
+    TankSpectrogram tankSpectrogram;
 
     // Smoothed metering values
     float smoothedInputLevel = 0.0f;
@@ -116,9 +167,16 @@ private:
 
     // APVTS Attachments
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> typeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> switchModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> switchTimeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> algoModeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> shimmerPitchAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> springQualityAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> springCountAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> preDelaySyncDivAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> diffuserTypeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> sidechainTargetAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> duckDetectionAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> preDelayAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> preDelayTempoSyncAttachment;
@@ -134,18 +192,34 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lowPassAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckingAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sidechainHighPassAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sidechainLowPassAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckThresholdAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckRatioAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckAttackAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> duckReleaseAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> shimmerAmountAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> shimmerSaturationAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> shimmerInfiniteAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> shimmerFormantAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> springTensionAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> springDripAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> springMixAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> springKickAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateThresholdAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateAttackAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateHoldAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateReleaseAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateShapeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> gateLookaheadAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> gateCurveAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> gateRetriggerAttachment;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> reverseLengthAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> reverseRiseAttachment;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> freezeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> bypassAttachment;
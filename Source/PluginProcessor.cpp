@@ -4,22 +4,39 @@
 DynoverbAudioProcessor::DynoverbAudioProcessor()
     : AudioProcessor(BusesProperties()
                      .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                     .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)
                      .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
       apvts(*this, nullptr, "Parameters", createParameterLayout())
 {
     // Cache parameter pointers
     reverbTypeParam = apvts.getRawParameterValue("reverbType");
+    switchModeParam = apvts.getRawParameterValue("switchMode");
+    switchTimeParam = apvts.getRawParameterValue("switchTime");
     algoModeParam = apvts.getRawParameterValue("algoMode");
     shimmerPitchParam = apvts.getRawParameterValue("shimmerPitch");
     shimmerAmountParam = apvts.getRawParameterValue("shimmerAmount");
     shimmerInfiniteParam = apvts.getRawParameterValue("shimmerInfinite");
+    shimmerSaturationParam = apvts.getRawParameterValue("shimmerSaturation");
+    shimmerFormantParam = apvts.getRawParameterValue("shimmerFormant");
     springTensionParam = apvts.getRawParameterValue("springTension");
     springDripParam = apvts.getRawParameterValue("springDrip");
     springMixParam = apvts.getRawParameterValue("springMix");
+    springKickParam = apvts.getRawParameterValue("springKick");
+    springQualityParam = apvts.getRawParameterValue("springQuality");
+    springCountParam = apvts.getRawParameterValue("springCount");
     gateThresholdParam = apvts.getRawParameterValue("gateThreshold");
+    gateAttackParam = apvts.getRawParameterValue("gateAttack");
     gateHoldParam = apvts.getRawParameterValue("gateHold");
     gateReleaseParam = apvts.getRawParameterValue("gateRelease");
     gateShapeParam = apvts.getRawParameterValue("gateShape");
+    gateLookaheadParam = apvts.getRawParameterValue("gateLookahead");
+    gateCurveParam = apvts.getRawParameterValue("gateCurve");
+    gateRetriggerParam = apvts.getRawParameterValue("gateRetrigger");
+    reverseLengthParam = apvts.getRawParameterValue("reverseLength");
+    reverseRiseParam = apvts.getRawParameterValue("reverseRise");
+    sidechainTargetParam = apvts.getRawParameterValue("sidechainTarget");
+    sidechainHighPassParam = apvts.getRawParameterValue("sidechainHighPass");
+    sidechainLowPassParam = apvts.getRawParameterValue("sidechainLowPass");
 
     preDelayParam = apvts.getRawParameterValue("preDelay");
     preDelayTempoSyncParam = apvts.getRawParameterValue("preDelayTempoSync");
@@ -28,6 +45,7 @@ DynoverbAudioProcessor::DynoverbAudioProcessor()
     dampingParam = apvts.getRawParameterValue("damping");
     sizeParam = apvts.getRawParameterValue("size");
     diffusionParam = apvts.getRawParameterValue("diffusion");
+    diffuserTypeParam = apvts.getRawParameterValue("diffuserType");
     modRateParam = apvts.getRawParameterValue("modRate");
     modDepthParam = apvts.getRawParameterValue("modDepth");
     earlyLevelParam = apvts.getRawParameterValue("earlyLevel");
@@ -35,13 +53,28 @@ DynoverbAudioProcessor::DynoverbAudioProcessor()
     highPassParam = apvts.getRawParameterValue("highPass");
     lowPassParam = apvts.getRawParameterValue("lowPass");
     duckingParam = apvts.getRawParameterValue("ducking");
+    duckThresholdParam = apvts.getRawParameterValue("duckThreshold");
+    duckRatioParam = apvts.getRawParameterValue("duckRatio");
+    duckAttackParam = apvts.getRawParameterValue("duckAttack");
+    duckReleaseParam = apvts.getRawParameterValue("duckRelease");
+    duckDetectionParam = apvts.getRawParameterValue("duckDetection");
     mixParam = apvts.getRawParameterValue("mix");
     freezeParam = apvts.getRawParameterValue("freeze");
     bypassParam = apvts.getRawParameterValue("bypass");
+
+    // Any change is picked up at the next sub-block boundary
+    for (auto* parameter : getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            apvts.addParameterListener(ranged->getParameterID(), this);
 }
 
 DynoverbAudioProcessor::~DynoverbAudioProcessor()
 {
+    for (auto* parameter : getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            apvts.removeParameterListener(ranged->getParameterID(), this);
+
+    cancelPendingUpdate();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::createParameterLayout()
@@ -51,7 +84,17 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
     // Reverb type selection
     params.push_back(std::make_unique<juce::AudioParameterChoice>(
         juce::ParameterID("reverbType", 1), "Reverb Type",
-        juce::StringArray{ "Algorithmic", "Shimmer", "Spring", "Gated" }, 0));
+        juce::StringArray{ "Algorithmic", "Shimmer", "Spring", "Gated", "Plate", "Reverse" }, 0));
+
+    // Type switching
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("switchMode", 1), "Type Switch",
+        juce::StringArray{ "Crossfade", "Ring Out" }, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("switchTime", 1), "Switch Time",
+        juce::NormalisableRange<float>(1.0f, 1000.0f, 1.0f, 0.4f), 20.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
 
     // Algorithmic mode
     params.push_back(std::make_unique<juce::AudioParameterChoice>(
@@ -71,6 +114,14 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         juce::ParameterID("shimmerInfinite", 1), "Shimmer Infinite", false));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("shimmerSaturation", 1), "Shimmer Saturation",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("%")));
+
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("shimmerFormant", 1), "Shimmer Formant Preserve", false));
+
     // Spring parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("springTension", 1), "Spring Tension",
@@ -87,12 +138,30 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 70.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("springKick", 1), "Spring Kick",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("%")));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("springQuality", 1), "Spring Quality",
+        juce::StringArray{ "Standard", "High (2x)" }, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("springCount", 1), "Spring Count",
+        juce::StringArray{ "2", "3", "4", "6" }, 1));
+
     // Gated parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("gateThreshold", 1), "Gate Threshold",
         juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -30.0f,
         juce::AudioParameterFloatAttributes().withLabel("dB")));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("gateAttack", 1), "Gate Attack",
+        juce::NormalisableRange<float>(0.0f, 500.0f, 0.1f, 0.3f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("gateHold", 1), "Gate Hold",
         juce::NormalisableRange<float>(10.0f, 500.0f, 1.0f, 0.5f), 100.0f,
@@ -108,6 +177,30 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 50.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("gateLookahead", 1), "Gate Lookahead",
+        juce::NormalisableRange<float>(0.0f, 10.0f, 0.1f), 0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("gateCurve", 1), "Gate Curve",
+        juce::StringArray{ "Shaped", "Linear", "Exponential", "Nonlinear" }, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("gateRetrigger", 1), "Gate Retrigger",
+        juce::StringArray{ "Legato", "Restart", "Ignore" }, 0));
+
+    // Reverse parameters
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("reverseLength", 1), "Reverse Length",
+        juce::NormalisableRange<float>(50.0f, 1000.0f, 1.0f, 0.5f), 400.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("reverseRise", 1), "Reverse Rise",
+        juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 60.0f,
+        juce::AudioParameterFloatAttributes().withLabel("%")));
+
     // Global parameters
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("preDelay", 1), "Pre-Delay",
@@ -141,6 +234,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 70.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
 
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("diffuserType", 1), "Diffuser Type",
+        juce::StringArray{ "Classic", "Nested", "Modulated" }, 0));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("modRate", 1), "Mod Rate",
         juce::NormalisableRange<float>(0.01f, 5.0f, 0.01f, 0.5f), 0.5f,
@@ -176,11 +273,50 @@ juce::AudioProcessorValueTreeState::ParameterLayout DynoverbAudioProcessor::crea
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 0.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
 
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("duckThreshold", 1), "Duck Threshold",
+        juce::NormalisableRange<float>(-60.0f, 0.0f, 0.1f), -30.0f,
+        juce::AudioParameterFloatAttributes().withLabel("dB")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("duckRatio", 1), "Duck Ratio",
+        juce::NormalisableRange<float>(1.0f, 20.0f, 0.1f, 0.5f), 4.0f,
+        juce::AudioParameterFloatAttributes().withLabel(":1")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("duckAttack", 1), "Duck Attack",
+        juce::NormalisableRange<float>(0.1f, 100.0f, 0.1f, 0.4f), 5.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("duckRelease", 1), "Duck Release",
+        juce::NormalisableRange<float>(10.0f, 2000.0f, 1.0f, 0.4f), 150.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("duckDetection", 1), "Duck Detection",
+        juce::StringArray{ "Peak", "RMS" }, 0));
+
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         juce::ParameterID("mix", 1), "Mix",
         juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f), 30.0f,
         juce::AudioParameterFloatAttributes().withLabel("%")));
 
+    // Sidechain key
+    params.push_back(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("sidechainTarget", 1), "Sidechain Keys",
+        juce::StringArray{ "Off", "Gate", "Ducker", "Gate + Ducker" }, 0));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("sidechainHighPass", 1), "Key High Pass",
+        juce::NormalisableRange<float>(20.0f, 2000.0f, 1.0f, 0.4f), 20.0f,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("sidechainLowPass", 1), "Key Low Pass",
+        juce::NormalisableRange<float>(1000.0f, 20000.0f, 1.0f, 0.4f), 20000.0f,
+        juce::AudioParameterFloatAttributes().withLabel("Hz")));
+
     params.push_back(std::make_unique<juce::AudioParameterBool>(
         juce::ParameterID("freeze", 1), "Freeze", false));
 
@@ -208,14 +344,54 @@ void DynoverbAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
     shimmerReverb.prepare(sampleRate, samplesPerBlock);
     springReverb.prepare(sampleRate, samplesPerBlock);
     gatedReverb.prepare(sampleRate, samplesPerBlock);
-
-    crossfadeBuffer.setSize(2, samplesPerBlock);
-
-    // Setup ducking envelope followers
-    duckingEnvelopeL.setAttack(sampleRate, 5.0f);
-    duckingEnvelopeL.setRelease(sampleRate, 100.0f);
-    duckingEnvelopeR.setAttack(sampleRate, 5.0f);
-    duckingEnvelopeR.setRelease(sampleRate, 100.0f);
+    plateReverb.prepare(sampleRate, samplesPerBlock);
+    reverseReverb.prepare(sampleRate, samplesPerBlock);
+
+    // Report the latency before the first block, hosts query it here
+    gatedReverb.setLookahead(gateLookaheadParam->load());
+    reverseReverb.setReverseLength(reverseLengthParam->load());
+    reportedLatency.store(getEngineLatency(getCurrentReverbType()));
+    setLatencySamples(reportedLatency.load());
+
+    crossfadeBuffer.setSize(2, subBlockSize);
+
+    // Dry path delay, long enough for any engine's latency
+    const int maxLatencySamples = static_cast<int>(std::ceil(sampleRate * maxLatencySeconds));
+    dryDelayL.prepare(maxLatencySamples + 1, subBlockSize);
+    dryDelayR.prepare(maxLatencySamples + 1, subBlockSize);
+    keyDelayL.prepare(maxLatencySamples + 1, subBlockSize);
+    keyDelayR.prepare(maxLatencySamples + 1, subBlockSize);
+    dryLatency = reportedLatency.load();
+    dryFade = 1.0f;
+    dryFadeStep = 1.0f / std::max(1.0f, static_cast<float>(sampleRate) * dryFadeMs * 0.001f);
+    sidechainBuffer.setSize(2, subBlockSize);
+    sidechainHighPass.reset();
+    sidechainLowPass.reset();
+
+    // Start the sub-block grid again and read every parameter before the
+    // first block
+    samplePosition = 0;
+    parametersChanged.store(true);
+
+    // The engines were just cleared, so any switch in progress is over
+    currentType = targetType;
+    outgoingActive = false;
+    retiringOutgoing = false;
+    crossfadePosition = 1.0f;
+    retireStep = 1.0f / std::max(1.0f, static_cast<float>(sampleRate) * retireMs * 0.001f);
+    silenceHoldSamples = static_cast<int>(sampleRate * silenceHoldMs / 1000.0);
+    maxRingOutSamples = static_cast<int>(sampleRate * maxRingOutSeconds);
+
+    // The first targets after this snap, so playback starts on the settings
+    decaySmoother.prepare(sampleRate, parameterRampMs);
+    dampingSmoother.prepare(sampleRate, parameterRampMs);
+    highPassSmoother.prepare(sampleRate, parameterRampMs);
+    lowPassSmoother.prepare(sampleRate, parameterRampMs);
+    duckingSmoother.prepare(sampleRate, parameterRampMs);
+    mixSmoother.prepare(sampleRate, gainRampMs);
+    widthSmoother.prepare(sampleRate, gainRampMs);
+
+    ducker.prepare(sampleRate);
 }
 
 void DynoverbAudioProcessor::releaseResources()
@@ -228,7 +404,16 @@ bool DynoverbAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
         && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
 
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    // Mono in with mono or stereo out, or stereo in and out
+    if (layouts.getMainInputChannelSet() != juce::AudioChannelSet::mono()
+        && layouts.getMainInputChannelSet() != layouts.getMainOutputChannelSet())
+        return false;
+
+    // Sidechain off, mono or stereo
+    auto sidechain = layouts.getChannelSet(true, 1);
+    if (!sidechain.isDisabled()
+        && sidechain != juce::AudioChannelSet::mono()
+        && sidechain != juce::AudioChannelSet::stereo())
         return false;
 
     return true;
@@ -239,6 +424,122 @@ ReverbType DynoverbAudioProcessor::getCurrentReverbType() const
     return static_cast<ReverbType>(static_cast<int>(reverbTypeParam->load()));
 }
 
+bool DynoverbAudioProcessor::prepareSidechain()
+{
+    auto* sidechainBus = getBus(true, 1);
+    if (static_cast<int>(sidechainTargetParam->load()) == 0
+        || sidechainBus == nullptr || !sidechainBus->isEnabled() || sidechainBus->getNumberOfChannels() == 0)
+        return false;
+
+    // Key filters, so e.g. only the kick opens the gate
+    sidechainHighPass.setCoefficients(DSPUtils::calcHighPass(getSampleRate(), sidechainHighPassParam->load()));
+    sidechainLowPass.setCoefficients(DSPUtils::calcLowPass(getSampleRate(), sidechainLowPassParam->load()));
+    return true;
+}
+
+void DynoverbAudioProcessor::readSidechainKey(const juce::AudioBuffer<float>& sidechain, int start, int numSamples)
+{
+    // A mono key feeds both detector channels
+    sidechainBuffer.copyFrom(0, 0, sidechain, 0, start, numSamples);
+    sidechainBuffer.copyFrom(1, 0, sidechain, sidechain.getNumChannels() > 1 ? 1 : 0, start, numSamples);
+
+    auto* keyL = sidechainBuffer.getWritePointer(0);
+    auto* keyR = sidechainBuffer.getWritePointer(1);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        sidechainHighPass.process(keyL[i], keyR[i]);
+        sidechainLowPass.process(keyL[i], keyR[i]);
+    }
+}
+
+int DynoverbAudioProcessor::getEngineLatency(ReverbType type) const
+{
+    // Only the gated and reverse engines delay their output
+    switch (type)
+    {
+        case ReverbType::Gated: return gatedReverb.getLatencySamples();
+        case ReverbType::Reverse: return reverseReverb.getLatencySamples();
+        default: return 0;
+    }
+}
+
+ReverbBase& DynoverbAudioProcessor::getEngine(ReverbType type)
+{
+    switch (type)
+    {
+        case ReverbType::Shimmer: return shimmerReverb;
+        case ReverbType::Spring: return springReverb;
+        case ReverbType::Gated: return gatedReverb;
+        case ReverbType::Plate: return plateReverb;
+        case ReverbType::Reverse: return reverseReverb;
+        case ReverbType::Algorithmic:
+        default: return algorithmicReverb;
+    }
+}
+
+void DynoverbAudioProcessor::runEngines(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>* incoming,
+                                        const float* gateKeyL, const float* gateKeyR)
+{
+    auto& engine = getEngine(incoming ? currentType : targetType);
+    auto& incomingEngine = getEngine(targetType);
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+
+    // While decay, damping or a filter frequency is gliding, the engines run
+    // in control steps with the next values applied between them. Otherwise
+    // the block goes through in one call. The steps are views into the
+    // buffers, nothing is copied.
+    for (int start = 0; start < numSamples;)
+    {
+        int stepSize = numSamples - start;
+        if (decaySmoother.isSmoothing() || dampingSmoother.isSmoothing() ||
+            highPassSmoother.isSmoothing() || lowPassSmoother.isSmoothing())
+        {
+            stepSize = std::min(stepSize, controlStepSize);
+
+            const float decay = decaySmoother.skip(stepSize);
+            const float dampingVal = dampingSmoother.skip(stepSize);
+            const float highPassVal = std::exp(highPassSmoother.skip(stepSize));
+            const float lowPassVal = std::exp(lowPassSmoother.skip(stepSize));
+            for (ReverbType type : { currentType, targetType })
+            {
+                auto& steppedEngine = getEngine(type);
+                steppedEngine.setDecay(decay);
+                steppedEngine.setDamping(dampingVal);
+                steppedEngine.setHighPassFreq(highPassVal);
+                steppedEngine.setLowPassFreq(lowPassVal);
+            }
+        }
+
+        // The gate reads its key from the start of each call
+        gatedReverb.setSidechain(gateKeyL ? gateKeyL + start : nullptr,
+                                 gateKeyR ? gateKeyR + start : nullptr);
+
+        juce::AudioBuffer<float> step(buffer.getArrayOfWritePointers(), numChannels, start, stepSize);
+        engine.process(step);
+
+        if (incoming)
+        {
+            juce::AudioBuffer<float> incomingStep(incoming->getArrayOfWritePointers(),
+                                                  incoming->getNumChannels(), start, stepSize);
+            incomingEngine.process(incomingStep);
+        }
+
+        start += stepSize;
+    }
+}
+
+void DynoverbAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(reportedLatency.load());
+}
+
+void DynoverbAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    juce::ignoreUnused(parameterID, newValue);
+    parametersChanged.store(true);
+}
+
 void DynoverbAudioProcessor::updateReverbParameters()
 {
     // Get global parameters
@@ -255,19 +556,43 @@ void DynoverbAudioProcessor::updateReverbParameters()
         preDelay = std::min(preDelay, 500.0f);
     }
 
-    float decay = decayParam->load();
-    float dampingVal = dampingParam->load() / 100.0f;
+    // Decay, damping and the filter frequencies glide in control steps, see
+    // runEngines(). The engines start from wherever the glide is now.
+    // Frequencies glide in the log domain so every octave takes as long.
+    decaySmoother.setTarget(decayParam->load());
+    dampingSmoother.setTarget(dampingParam->load() / 100.0f);
+    highPassSmoother.setTarget(std::log(highPassParam->load()));
+    lowPassSmoother.setTarget(std::log(lowPassParam->load()));
+
+    // Type switch fade length
+    crossfadeStep = 1.0f / std::max(1.0f, switchTimeParam->load() * 0.001f * static_cast<float>(getSampleRate()));
+
+    // Mix, width and the ducker belong to the output stage, not the engines
+    mixSmoother.setTarget(mixParam->load() / 100.0f);
+    widthSmoother.setTarget(widthParam->load() / 100.0f);
+    ducker.setThreshold(duckThresholdParam->load());
+    ducker.setRatio(duckRatioParam->load());
+    ducker.setAttack(duckAttackParam->load());
+    ducker.setRelease(duckReleaseParam->load());
+    ducker.setDetection(static_cast<DSPUtils::DuckerDetection>(static_cast<int>(duckDetectionParam->load())));
+
+    float decay = decaySmoother.getCurrent();
+    float dampingVal = dampingSmoother.getCurrent();
     float sizeVal = sizeParam->load() / 100.0f;
     float diffusionVal = diffusionParam->load() / 100.0f;
     float modRateVal = modRateParam->load();
     float modDepthVal = modDepthParam->load() / 100.0f;
     float earlyLevelVal = earlyLevelParam->load() / 100.0f;
-    float widthVal = widthParam->load() / 100.0f;
-    float highPassVal = highPassParam->load();
-    float lowPassVal = lowPassParam->load();
-    float mixVal = mixParam->load() / 100.0f;
+    float highPassVal = std::exp(highPassSmoother.getCurrent());
+    float lowPassVal = std::exp(lowPassSmoother.getCurrent());
     bool frozen = freezeParam->load() > 0.5f;
 
+    // Diffuser topology, shared by every engine
+    const DSPUtils::DiffuserTopology diffuserTopologies[] = { DSPUtils::DiffuserTopology::Classic,
+                                                              DSPUtils::DiffuserTopology::Nested,
+                                                              DSPUtils::DiffuserTopology::Modulated };
+    const auto diffuserTopology = diffuserTopologies[std::clamp(static_cast<int>(diffuserTypeParam->load()), 0, 2)];
+
     // Update algorithmic reverb
     algorithmicReverb.setMode(static_cast<AlgorithmicMode>(static_cast<int>(algoModeParam->load())));
     algorithmicReverb.setPreDelay(preDelay);
@@ -275,206 +600,488 @@ void DynoverbAudioProcessor::updateReverbParameters()
     algorithmicReverb.setDamping(dampingVal);
     algorithmicReverb.setSize(sizeVal);
     algorithmicReverb.setDiffusion(diffusionVal);
+    algorithmicReverb.setDiffuserTopology(diffuserTopology);
     algorithmicReverb.setModRate(modRateVal);
     algorithmicReverb.setModDepth(modDepthVal);
     algorithmicReverb.setEarlyLevel(earlyLevelVal);
-    algorithmicReverb.setWidth(widthVal);
     algorithmicReverb.setHighPassFreq(highPassVal);
     algorithmicReverb.setLowPassFreq(lowPassVal);
-    algorithmicReverb.setMix(mixVal);
     algorithmicReverb.setFreeze(frozen);
 
     // Update shimmer reverb
     shimmerReverb.setPitchMode(static_cast<ShimmerPitch>(static_cast<int>(shimmerPitchParam->load())));
     shimmerReverb.setShimmerAmount(shimmerAmountParam->load() / 100.0f);
     shimmerReverb.setInfinite(shimmerInfiniteParam->load() > 0.5f);
+    shimmerReverb.setSaturation(shimmerSaturationParam->load() / 100.0f);
+    shimmerReverb.setFormantPreserve(shimmerFormantParam->load() > 0.5f);
     shimmerReverb.setPreDelay(preDelay);
     shimmerReverb.setDecay(decay);
     shimmerReverb.setDamping(dampingVal);
     shimmerReverb.setSize(sizeVal);
     shimmerReverb.setDiffusion(diffusionVal);
+    shimmerReverb.setDiffuserTopology(diffuserTopology);
     shimmerReverb.setModRate(modRateVal);
     shimmerReverb.setModDepth(modDepthVal);
-    shimmerReverb.setWidth(widthVal);
     shimmerReverb.setHighPassFreq(highPassVal);
     shimmerReverb.setLowPassFreq(lowPassVal);
-    shimmerReverb.setMix(mixVal);
     shimmerReverb.setFreeze(frozen);
 
     // Update spring reverb
     springReverb.setTension(springTensionParam->load() / 100.0f);
     springReverb.setDrip(springDripParam->load() / 100.0f);
     springReverb.setSpringMix(springMixParam->load() / 100.0f);
+    springReverb.setKick(springKickParam->load() / 100.0f);
+    springReverb.setOversampling(static_cast<int>(springQualityParam->load()) == 1);
+    const int springCounts[] = { 2, 3, 4, 6 };
+    springReverb.setSpringCount(springCounts[std::clamp(static_cast<int>(springCountParam->load()), 0, 3)]);
     springReverb.setPreDelay(preDelay);
     springReverb.setDecay(decay);
     springReverb.setDamping(dampingVal);
     springReverb.setSize(sizeVal);
     springReverb.setDiffusion(diffusionVal);
-    springReverb.setWidth(widthVal);
+    springReverb.setDiffuserTopology(diffuserTopology);
     springReverb.setHighPassFreq(highPassVal);
     springReverb.setLowPassFreq(lowPassVal);
-    springReverb.setMix(mixVal);
     springReverb.setFreeze(frozen);
 
     // Update gated reverb
     gatedReverb.setThreshold(gateThresholdParam->load());
+    gatedReverb.setAttackTime(gateAttackParam->load());
     gatedReverb.setHoldTime(gateHoldParam->load());
     gatedReverb.setReleaseTime(gateReleaseParam->load());
     gatedReverb.setGateShape(gateShapeParam->load() / 100.0f);
+    gatedReverb.setLookahead(gateLookaheadParam->load());
+    gatedReverb.setReleaseCurve(static_cast<GateCurve>(static_cast<int>(gateCurveParam->load())));
+    gatedReverb.setRetriggerMode(static_cast<GateRetrigger>(static_cast<int>(gateRetriggerParam->load())));
     gatedReverb.setPreDelay(preDelay);
     gatedReverb.setDecay(decay);
     gatedReverb.setDamping(dampingVal);
     gatedReverb.setSize(sizeVal);
     gatedReverb.setDiffusion(diffusionVal);
+    gatedReverb.setDiffuserTopology(diffuserTopology);
     gatedReverb.setEarlyLevel(earlyLevelVal);
-    gatedReverb.setWidth(widthVal);
     gatedReverb.setHighPassFreq(highPassVal);
     gatedReverb.setLowPassFreq(lowPassVal);
-    gatedReverb.setMix(mixVal);
     gatedReverb.setFreeze(frozen);
+
+    // Update plate reverb
+    plateReverb.setPreDelay(preDelay);
+    plateReverb.setDecay(decay);
+    plateReverb.setDamping(dampingVal);
+    plateReverb.setSize(sizeVal);
+    plateReverb.setDiffusion(diffusionVal);
+    plateReverb.setModRate(modRateVal);
+    plateReverb.setModDepth(modDepthVal);
+    plateReverb.setHighPassFreq(highPassVal);
+    plateReverb.setLowPassFreq(lowPassVal);
+    plateReverb.setFreeze(frozen);
+
+    // Update reverse reverb
+    reverseReverb.setReverseLength(reverseLengthParam->load());
+    reverseReverb.setRise(reverseRiseParam->load() / 100.0f);
+    reverseReverb.setPreDelay(preDelay);
+    reverseReverb.setDamping(dampingVal);
+    reverseReverb.setSize(sizeVal);
+    reverseReverb.setDiffusion(diffusionVal);
+    reverseReverb.setDiffuserTopology(diffuserTopology);
+    reverseReverb.setHighPassFreq(highPassVal);
+    reverseReverb.setLowPassFreq(lowPassVal);
+    reverseReverb.setFreeze(frozen);
 }
 
-void DynoverbAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void DynoverbAudioProcessor::processBlock(juce::AudioBuffer<float>& hostBuffer, juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused(midiMessages);
     juce::ScopedNoDenormals noDenormals;
 
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    auto mainInputChannels = getMainBusNumInputChannels();
+    auto mainOutputChannels = getMainBusNumOutputChannels();
+
+    // The sidechain key can share channels with the main outputs, so it is
+    // read a sub-block at a time, before that span of the outputs is written
+    const bool sidechainActive = prepareSidechain();
+    const auto sidechain = sidechainActive ? getBusBuffer(hostBuffer, true, 1) : juce::AudioBuffer<float>();
 
-    // Clear unused output channels
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+    // From here on only the main bus is processed
+    auto buffer = getBusBuffer(hostBuffer, false, 0);
 
-    // Check bypass
+    // Check bypass. The input still goes through the dry delay, so the
+    // timing does not move against the latency reported to the host.
     if (bypassParam->load() > 0.5f)
+    {
+        if (mainInputChannels > 0)
+        {
+            auto* left = buffer.getWritePointer(0);
+            auto* right = mainInputChannels > 1 && mainOutputChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+
+            setDryLatency(reportedLatency.load());
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const float fade = nextDryFade();
+                dryDelayL.push(left[i]);
+                dryDelayR.push(right ? right[i] : left[i]);
+                left[i] = readDelayed(dryDelayL, fade);
+                if (right)
+                    right[i] = readDelayed(dryDelayR, fade);
+            }
+        }
+
+        for (auto i = mainInputChannels; i < mainOutputChannels; ++i)
+            buffer.clear(i, 0, buffer.getNumSamples());
         return;
+    }
 
     // Get playhead info for tempo sync
     if (auto* playhead = getPlayHead())
     {
         if (auto posInfo = playhead->getPosition())
         {
-            if (posInfo->getBpm().hasValue())
+            // A tempo change moves the synced pre-delay
+            if (posInfo->getBpm().hasValue() && *posInfo->getBpm() != currentBPM)
+            {
                 currentBPM = *posInfo->getBpm();
+                parametersChanged.store(true);
+            }
         }
     }
 
     // Measure input level
     float inLevel = 0.0f;
-    for (int ch = 0; ch < totalNumInputChannels; ++ch)
+    for (int ch = 0; ch < mainInputChannels; ++ch)
         inLevel = std::max(inLevel, buffer.getMagnitude(ch, 0, buffer.getNumSamples()));
     inputLevel.store(inLevel);
 
+    // Mono sources take each engine's single-chain input path
+    monoSource = mainInputChannels == 1;
+    algorithmicReverb.setMonoInput(monoSource);
+    shimmerReverb.setMonoInput(monoSource);
+    springReverb.setMonoInput(monoSource);
+    gatedReverb.setMonoInput(monoSource);
+    plateReverb.setMonoInput(monoSource);
+    reverseReverb.setMonoInput(monoSource);
+
+    // Route the sidechain key to the gate and/or the ducker
+    // (sidechainTarget: 0 = off, 1 = gate, 2 = ducker, 3 = both)
+    const int sidechainTarget = static_cast<int>(sidechainTargetParam->load());
+    gateKeyed = sidechainActive && (sidechainTarget == 1 || sidechainTarget == 3);
+    duckerKeyed = sidechainActive && (sidechainTarget == 2 || sidechainTarget == 3);
+
+    // The ducking amount glides per sample. The ducker runs while it is
+    // above zero or on its way down, and starts from rest whenever it is
+    // switched on.
+    duckingSmoother.setTarget(duckingParam->load() / 100.0f);
+    const bool wasDucking = ducking;
+    ducking = duckingSmoother.getTarget() > 0.0f || duckingSmoother.isSmoothing();
+    if (ducking && !wasDucking)
+        ducker.reset();
+
+    // Run the block a sub-block at a time, each ending on the grid
+    const int numSamples = buffer.getNumSamples();
+    for (int start = 0; start < numSamples;)
+    {
+        const int untilBoundary = subBlockSize - static_cast<int>(samplePosition % subBlockSize);
+        const int subBlockLength = std::min(untilBoundary, numSamples - start);
+
+        // Key first, then clear unused output channels
+        if (sidechainActive)
+            readSidechainKey(sidechain, start, subBlockLength);
+        for (auto i = mainInputChannels; i < mainOutputChannels; ++i)
+            buffer.clear(i, start, subBlockLength);
+
+        processSubBlock(buffer, start, subBlockLength);
+
+        start += subBlockLength;
+        samplePosition += subBlockLength;
+    }
+
+    // Measure output level
+    float outLevel = 0.0f;
+    for (int ch = 0; ch < mainOutputChannels; ++ch)
+        outLevel = std::max(outLevel, buffer.getMagnitude(ch, 0, buffer.getNumSamples()));
+    outputLevel.store(outLevel);
+}
+
+void DynoverbAudioProcessor::processSubBlock(juce::AudioBuffer<float>& hostBlock, int start, int numSamples)
+{
     // Update parameters
-    updateReverbParameters();
+    if (parametersChanged.exchange(false))
+        updateReverbParameters();
 
     // Check for type change and setup crossfade
     ReverbType newType = static_cast<ReverbType>(static_cast<int>(reverbTypeParam->load()));
-    if (newType != targetType)
+    if (retiringOutgoing)
     {
-        currentType = targetType;
-        targetType = newType;
-        crossfadePosition = 0.0f;
+        // The retired engine is silent: clear it, and the engine fading in
+        // hands over to the latest type from the level it has reached
+        if (retirePosition >= 1.0f && newType != targetType)
+        {
+            getEngine(currentType).reset();
+            retiringOutgoing = false;
+            const bool wasRingingOut = ringingOut;
+            beginTypeSwitch(newType, 1.0f - crossfadePosition);
+
+            // Its output was at unity if the last switch rang out and on the
+            // fade if not, and the new switch has to start from there
+            if (wasRingingOut && !ringingOut)
+                crossfadePosition = 0.0f;
+            ringingOut = ringingOut && wasRingingOut;
+        }
+    }
+    else if (newType != targetType)
+    {
+        if (!outgoingActive)
+            beginTypeSwitch(newType, 0.0f);
+        else if (newType == currentType)
+            beginTypeSwitch(newType, 1.0f - crossfadePosition);  // Back the way it came
+        else
+        {
+            // A third engine mid-switch: the oldest one fades out first
+            retiringOutgoing = true;
+            retirePosition = 0.0f;
+        }
     }
 
-    // Get ducking amount
-    float duckingAmount = duckingParam->load() / 100.0f;
+    // Ringing out for too long, or held since the switch: fade the tail out
+    if (ringingOut && !tailFading && (ringOutSamples >= maxRingOutSamples || tailNeverEnds(currentType)))
+        tailFading = true;
 
-    // Store dry signal for ducking
-    juce::AudioBuffer<float> dryBuffer;
-    if (duckingAmount > 0.0f)
+    // Latency follows the engine being switched to
+    const int latency = getEngineLatency(targetType);
+    if (latency != reportedLatency.load())
     {
-        dryBuffer.makeCopyOf(buffer);
+        reportedLatency.store(latency);
+        triggerAsyncUpdate();
     }
 
+    // This sub-block of the host buffer, and its key
+    juce::AudioBuffer<float> buffer(hostBlock.getArrayOfWritePointers(), hostBlock.getNumChannels(), start, numSamples);
+    const float* gateKeyL = gateKeyed ? sidechainBuffer.getReadPointer(0) : nullptr;
+    const float* gateKeyR = gateKeyed ? sidechainBuffer.getReadPointer(1) : nullptr;
+
+    // Capture the dry input before the engines replace it
+    auto* leftIn = buffer.getReadPointer(0);
+    auto* rightIn = buffer.getNumChannels() > 1 && !monoSource ? buffer.getReadPointer(1) : leftIn;
+    std::copy(leftIn, leftIn + numSamples, dryL.begin());
+    std::copy(rightIn, rightIn + numSamples, dryR.begin());
+
     // Process based on type (with crossfading if transitioning)
-    if (crossfadePosition < 1.0f)
+    if (outgoingActive)
     {
-        // Make copy for crossfade
-        crossfadeBuffer.makeCopyOf(buffer);
+        // Equal-power gains along the fade
+        constexpr float halfPi = 1.57079632679489661923f;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float position = std::min(1.0f, crossfadePosition + static_cast<float>(i) * crossfadeStep);
+            fadeInGains[i] = std::sin(position * halfPi);
+            fadeOutGains[i] = std::sin((1.0f - position) * halfPi);
+        }
 
-        // Process current type
-        switch (currentType)
+        // Ringing out, the outgoing output stays at unity until its tail fades
+        if (ringingOut)
         {
-            case ReverbType::Algorithmic: algorithmicReverb.process(buffer); break;
-            case ReverbType::Shimmer: shimmerReverb.process(buffer); break;
-            case ReverbType::Spring: springReverb.process(buffer); break;
-            case ReverbType::Gated: gatedReverb.process(buffer); break;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float position = tailFading ? std::min(1.0f, tailFadePosition + static_cast<float>(i) * crossfadeStep) : 0.0f;
+                tailGains[i] = std::cos(position * halfPi);
+            }
         }
 
-        // Process target type
-        switch (targetType)
+        // Retiring, the outgoing output fades out over retireMs whatever the mode
+        if (retiringOutgoing)
+        {
+            float* outgoingGains = ringingOut ? tailGains.data() : fadeOutGains.data();
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float position = std::min(1.0f, retirePosition + static_cast<float>(i + 1) * retireStep);
+                outgoingGains[i] *= std::cos(position * halfPi);
+            }
+            retirePosition = std::min(1.0f, retirePosition + static_cast<float>(numSamples) * retireStep);
+        }
+
+        // Make copy for crossfade
+        juce::AudioBuffer<float> incoming(crossfadeBuffer.getArrayOfWritePointers(),
+                                          buffer.getNumChannels(), 0, numSamples);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            incoming.copyFrom(ch, 0, buffer, ch, 0, numSamples);
+
+        // Ringing out, the inputs crossfade and the outputs are left alone
+        if (ringingOut)
         {
-            case ReverbType::Algorithmic: algorithmicReverb.process(crossfadeBuffer); break;
-            case ReverbType::Shimmer: shimmerReverb.process(crossfadeBuffer); break;
-            case ReverbType::Spring: springReverb.process(crossfadeBuffer); break;
-            case ReverbType::Gated: gatedReverb.process(crossfadeBuffer); break;
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                auto* outgoingIn = buffer.getWritePointer(ch);
+                auto* incomingIn = incoming.getWritePointer(ch);
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    outgoingIn[i] *= fadeOutGains[i];
+                    incomingIn[i] *= fadeInGains[i];
+                }
+            }
         }
 
-        // Crossfade sample-by-sample
-        int numSamples = buffer.getNumSamples();
+        // Current type into buffer, target type into incoming
+        runEngines(buffer, &incoming, gateKeyL, gateKeyR);
+
+        float tailLevel = 0.0f;
         for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
         {
             auto* out = buffer.getWritePointer(ch);
-            auto* target = crossfadeBuffer.getReadPointer(ch);
+            auto* target = incoming.getReadPointer(ch);
 
-            for (int i = 0; i < numSamples; ++i)
+            if (ringingOut)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    out[i] *= tailGains[i];
+
+                tailLevel = std::max(tailLevel, buffer.getMagnitude(ch, 0, numSamples));
+                for (int i = 0; i < numSamples; ++i)
+                    out[i] += target[i];
+            }
+            else
             {
-                float fade = std::min(1.0f, crossfadePosition + i * crossfadeRate);
-                out[i] = out[i] * (1.0f - fade) + target[i] * fade;
+                for (int i = 0; i < numSamples; ++i)
+                    out[i] = out[i] * fadeOutGains[i] + target[i] * fadeInGains[i];
             }
         }
 
-        crossfadePosition += numSamples * crossfadeRate;
-        if (crossfadePosition >= 1.0f)
+        crossfadePosition = std::min(1.0f, crossfadePosition + static_cast<float>(numSamples) * crossfadeStep);
+        silentSamples = tailLevel < silenceThreshold ? silentSamples + numSamples : 0;
+        ringOutSamples += numSamples;
+        if (tailFading)
+            tailFadePosition = std::min(1.0f, tailFadePosition + static_cast<float>(numSamples) * crossfadeStep);
+
+        // Suspend the outgoing engine once it has nothing left to add
+        const bool tailDone = !ringingOut || silentSamples >= silenceHoldSamples || tailFadePosition >= 1.0f
+                              || retirePosition >= 1.0f;
+        if (crossfadePosition >= 1.0f && tailDone)
         {
-            crossfadePosition = 1.0f;
+            getEngine(currentType).reset();
             currentType = targetType;
+            outgoingActive = false;
+            retiringOutgoing = false;
         }
     }
     else
     {
         // Process single type
-        switch (targetType)
-        {
-            case ReverbType::Algorithmic: algorithmicReverb.process(buffer); break;
-            case ReverbType::Shimmer: shimmerReverb.process(buffer); break;
-            case ReverbType::Spring: springReverb.process(buffer); break;
-            case ReverbType::Gated: gatedReverb.process(buffer); break;
-        }
+        runEngines(buffer, nullptr, gateKeyL, gateKeyR);
     }
 
-    // Apply ducking
-    if (duckingAmount > 0.0f)
+    // Back to one signal: dry, ducked wet and width
+    mixOutput(buffer, latency);
+}
+
+void DynoverbAudioProcessor::beginTypeSwitch(ReverbType newType, float startPosition)
+{
+    crossfadePosition = startPosition;
+    currentType = targetType;
+    targetType = newType;
+    outgoingActive = true;
+    silentSamples = 0;
+    ringOutSamples = 0;
+    tailFading = false;
+    tailFadePosition = 0.0f;
+
+    // A tail that never dies away is crossfaded instead
+    ringingOut = static_cast<TypeSwitchMode>(static_cast<int>(switchModeParam->load())) == TypeSwitchMode::RingOut
+                 && !tailNeverEnds(currentType);
+}
+
+bool DynoverbAudioProcessor::tailNeverEnds(ReverbType type)
+{
+    // The top of the Decay range is near-infinite in every engine
+    return getEngine(type).holdsTail() || decayParam->load() >= 30.0f;
+}
+
+void DynoverbAudioProcessor::setDryLatency(int latency)
+{
+    if (dryFade >= 1.0f && latency != dryLatency)
     {
-        int numSamples = buffer.getNumSamples();
-        auto* leftIn = dryBuffer.getReadPointer(0);
-        auto* rightIn = dryBuffer.getNumChannels() > 1 ? dryBuffer.getReadPointer(1) : leftIn;
-        auto* leftOut = buffer.getWritePointer(0);
-        auto* rightOut = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
+        dryFadeFrom = dryLatency;
+        dryLatency = latency;
+        dryFade = 0.0f;
+    }
+}
 
-        for (int i = 0; i < numSamples; ++i)
-        {
-            float envL = duckingEnvelopeL.process(leftIn[i]);
-            float envR = duckingEnvelopeR.process(rightIn[i]);
-            float env = std::max(envL, envR);
+float DynoverbAudioProcessor::nextDryFade()
+{
+    const float fade = dryFade;
+    dryFade = std::min(1.0f, dryFade + dryFadeStep);
+    return fade;
+}
 
-            // Duck the reverb based on input level
-            float duckGain = 1.0f - env * duckingAmount * 3.0f;
-            duckGain = std::max(0.0f, duckGain);
+float DynoverbAudioProcessor::readDelayed(const DSPUtils::BlockDelay& line, float fade) const
+{
+    // Age 1 is the sample just pushed, so no latency reads it straight back
+    const float current = line.read(dryLatency + 1);
+    if (fade >= 1.0f)
+        return current;
 
-            leftOut[i] *= duckGain;
-            if (rightOut)
-                rightOut[i] *= duckGain;
-        }
+    const float previous = line.read(dryFadeFrom + 1);
+    return previous + (current - previous) * fade;
+}
+
+void DynoverbAudioProcessor::mixOutput(juce::AudioBuffer<float>& wet, int latency)
+{
+    const int numSamples = wet.getNumSamples();
+
+    // Dry path, delayed to line up with the wet signal. The external key
+    // takes the same delay; it is pushed even while unused so the line holds
+    // the recent key when the ducker starts.
+    setDryLatency(latency);
+    const float* sidechainL = sidechainBuffer.getReadPointer(0);
+    const float* sidechainR = sidechainBuffer.getReadPointer(1);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float fade = nextDryFade();
+        dryDelayL.push(dryL[i]);
+        dryDelayR.push(dryR[i]);
+        keyDelayL.push(duckerKeyed ? sidechainL[i] : 0.0f);
+        keyDelayR.push(duckerKeyed ? sidechainR[i] : 0.0f);
+        dryL[i] = readDelayed(dryDelayL, fade);
+        dryR[i] = readDelayed(dryDelayR, fade);
+        keyL[i] = readDelayed(keyDelayL, fade);
+        keyR[i] = readDelayed(keyDelayR, fade);
     }
 
-    // Measure output level
-    float outLevel = 0.0f;
-    for (int ch = 0; ch < totalNumInputChannels; ++ch)
-        outLevel = std::max(outLevel, buffer.getMagnitude(ch, 0, buffer.getNumSamples()));
-    outputLevel.store(outLevel);
+    // Ducking gain, following the delayed key or the delayed dry input
+    if (ducking)
+    {
+        const float* duckKeyL = duckerKeyed ? keyL.data() : dryL.data();
+        const float* duckKeyR = duckerKeyed ? keyR.data() : dryR.data();
+
+        // The ducking amount is the depth, it turns into the gain in place
+        duckingSmoother.fill(duckGains.data(), numSamples);
+        ducker.process(duckKeyL, duckKeyR, duckGains.data(), duckGains.data(), numSamples);
+    }
+    else
+    {
+        std::fill(duckGains.begin(), duckGains.begin() + numSamples, 1.0f);
+    }
+
+    mixSmoother.fill(mixGains.data(), numSamples);
+    widthSmoother.fill(widthGains.data(), numSamples);
+
+    // Width, ducking and mix in one pass with no branches
+    auto* leftOut = wet.getWritePointer(0);
+    auto* rightOut = wet.getNumChannels() > 1 ? wet.getWritePointer(1) : nullptr;
+    if (rightOut)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float mid = (leftOut[i] + rightOut[i]) * 0.5f;
+            const float side = (leftOut[i] - rightOut[i]) * 0.5f * widthGains[i];
+            const float wetGain = mixGains[i] * duckGains[i];
+            const float dryGain = 1.0f - mixGains[i];
+            leftOut[i] = dryL[i] * dryGain + (mid + side) * wetGain;
+            rightOut[i] = dryR[i] * dryGain + (mid - side) * wetGain;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+            leftOut[i] = dryL[i] * (1.0f - mixGains[i]) + leftOut[i] * mixGains[i] * duckGains[i];
+    }
 }
 
 juce::AudioProcessorEditor* DynoverbAudioProcessor::createEditor()
@@ -5,6 +5,8 @@
 #include "DSP/ShimmerReverb.h"
 #include "DSP/SpringReverb.h"
 #include "DSP/GatedReverb.h"
+#include "DSP/PlateReverb.h"
+#include "DSP/ReverseReverb.h"
 
 // Reverb type enumeration
 enum class ReverbType
@@ -12,10 +14,21 @@ enum class ReverbType
     Algorithmic = 0,
     Shimmer,
     Spring,
-    Gated
+    Gated,
+    Plate,
+    Reverse
 };
 
-class DynoverbAudioProcessor : public juce::AudioProcessor
+// What happens to the outgoing engine on a type change
+enum class TypeSwitchMode
+{
+    Crossfade = 0,   // Equal-power crossfade of the two outputs
+    RingOut          // Only the inputs crossfade, the old tail rings out
+};
+
+class DynoverbAudioProcessor : public juce::AudioProcessor,
+                               private juce::AsyncUpdater,
+                               private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     DynoverbAudioProcessor();
@@ -52,6 +65,7 @@ public:
     float getInputLevel() const { return inputLevel.load(); }
     float getOutputLevel() const { return outputLevel.load(); }
     float getGateLevel() const { return gatedReverb.getGateLevel(); }
+    TankAnalyzer& getShimmerTankAnalyzer() { return shimmerReverb.getTankAnalyzer(); }
 
     // Current reverb type
     ReverbType getCurrentReverbType() const;
@@ -65,29 +79,78 @@ private:
     ShimmerReverb shimmerReverb;
     SpringReverb springReverb;
     GatedReverb gatedReverb;
+    PlateReverb plateReverb;
+    ReverseReverb reverseReverb;
 
-    // Cross-fade state for smooth type switching
+    // Cross-fade state for smooth type switching. While outgoingActive,
+    // currentType is the engine being switched away from. Once its fade is
+    // over (and, ringing out, its tail has stayed below silenceThreshold for
+    // silenceHoldMs) it is suspended and cleared. A tail that is held or still
+    // ringing after maxRingOutSeconds fades out over the switch time instead.
+    // A third type picked mid-switch retires the outgoing engine over
+    // retireMs first; once it is silent the engine that was fading in hands
+    // over to the new one from the level it has reached.
     ReverbType currentType = ReverbType::Algorithmic;
     ReverbType targetType = ReverbType::Algorithmic;
+    bool outgoingActive = false;
+    bool ringingOut = false;
+    bool tailFading = false;
     float crossfadePosition = 1.0f;  // 1.0 = fully on target
-    static constexpr float crossfadeRate = 0.002f;
+    float crossfadeStep = 0.001f;    // Per sample, from the switch time
+    float tailFadePosition = 0.0f;
+    int silentSamples = 0;
+    int silenceHoldSamples = 2400;
+    int ringOutSamples = 0;
+    int maxRingOutSamples = 480000;
+    bool retiringOutgoing = false;
+    float retirePosition = 0.0f;
+    float retireStep = 0.0047f;
+    static constexpr float silenceThreshold = 3.0e-5f;   // About -90dB
+    static constexpr float silenceHoldMs = 50.0f;
+    static constexpr float maxRingOutSeconds = 10.0f;
+    static constexpr float retireMs = 5.0f;
+
+    // True when the engine's tail would never die away (freeze, shimmer
+    // infinite, or Decay at the top of its range)
+    bool tailNeverEnds(ReverbType type);
 
-    // Buffers for crossfading
+    // Starts crossfading from targetType to newType, startPosition along the fade
+    void beginTypeSwitch(ReverbType newType, float startPosition);
+
+    // Incoming engine's sub-block while crossfading
     juce::AudioBuffer<float> crossfadeBuffer;
 
     // Parameter pointers
     std::atomic<float>* reverbTypeParam = nullptr;
+    std::atomic<float>* switchModeParam = nullptr;
+    std::atomic<float>* switchTimeParam = nullptr;
     std::atomic<float>* algoModeParam = nullptr;
     std::atomic<float>* shimmerPitchParam = nullptr;
     std::atomic<float>* shimmerAmountParam = nullptr;
     std::atomic<float>* shimmerInfiniteParam = nullptr;
+    std::atomic<float>* shimmerSaturationParam = nullptr;
+    std::atomic<float>* shimmerFormantParam = nullptr;
     std::atomic<float>* springTensionParam = nullptr;
     std::atomic<float>* springDripParam = nullptr;
     std::atomic<float>* springMixParam = nullptr;
+    std::atomic<float>* springKickParam = nullptr;
+    std::atomic<float>* springQualityParam = nullptr;
+    std::atomic<float>* springCountParam = nullptr;
     std::atomic<float>* gateThresholdParam = nullptr;
+    std::atomic<float>* gateAttackParam = nullptr;
     std::atomic<float>* gateHoldParam = nullptr;
     std::atomic<float>* gateReleaseParam = nullptr;
     std::atomic<float>* gateShapeParam = nullptr;
+    std::atomic<float>* gateLookaheadParam = nullptr;
+    std::atomic<float>* gateCurveParam = nullptr;
+    std::atomic<float>* gateRetriggerParam = nullptr;
+
+    // Reverse parameters
+    std::atomic<float>* reverseLengthParam = nullptr;
+    std::atomic<float>* reverseRiseParam = nullptr;
+    std::atomic<float>* sidechainTargetParam = nullptr;
+    std::atomic<float>* sidechainHighPassParam = nullptr;
+    std::atomic<float>* sidechainLowPassParam = nullptr;
 
     // Global parameters
     std::atomic<float>* preDelayParam = nullptr;
@@ -97,6 +160,7 @@ private:
     std::atomic<float>* dampingParam = nullptr;
     std::atomic<float>* sizeParam = nullptr;
     std::atomic<float>* diffusionParam = nullptr;
+    std::atomic<float>* diffuserTypeParam = nullptr;
     std::atomic<float>* modRateParam = nullptr;
     std::atomic<float>* modDepthParam = nullptr;
     std::atomic<float>* earlyLevelParam = nullptr;
@@ -104,13 +168,44 @@ private:
     std::atomic<float>* highPassParam = nullptr;
     std::atomic<float>* lowPassParam = nullptr;
     std::atomic<float>* duckingParam = nullptr;
+    std::atomic<float>* duckThresholdParam = nullptr;
+    std::atomic<float>* duckRatioParam = nullptr;
+    std::atomic<float>* duckAttackParam = nullptr;
+    std::atomic<float>* duckReleaseParam = nullptr;
+    std::atomic<float>* duckDetectionParam = nullptr;
     std::atomic<float>* mixParam = nullptr;
     std::atomic<float>* freezeParam = nullptr;
     std::atomic<float>* bypassParam = nullptr;
 
-    // Ducking envelope follower
-    DSPUtils::EnvelopeFollower duckingEnvelopeL;
-    DSPUtils::EnvelopeFollower duckingEnvelopeR;
+    // Sidechain key for the current sub-block, filtered, and the key filters
+    juce::AudioBuffer<float> sidechainBuffer;
+    DSPUtils::StereoBiquad sidechainHighPass;
+    DSPUtils::StereoBiquad sidechainLowPass;
+
+    // Sets the key filters for the host block. Returns false when the
+    // sidechain is off or not connected.
+    bool prepareSidechain();
+
+    // Copies and filters numSamples of the key, from start in the sidechain
+    // bus, into sidechainBuffer
+    void readSidechainKey(const juce::AudioBuffer<float>& sidechain, int start, int numSamples);
+
+    // Wet-only ducker; the ducking parameter sets its depth
+    DSPUtils::Ducker ducker;
+
+    // Parameter glides. Decay, damping and the filters are set on the engines
+    // once per control step while they move, the filters in log frequency.
+    // Mix, width and the ducking amount move per sample in the output stage.
+    static constexpr int controlStepSize = 16;
+    static constexpr float parameterRampMs = 30.0f;
+    static constexpr float gainRampMs = 20.0f;
+    DSPUtils::LinearSmoother decaySmoother;
+    DSPUtils::LinearSmoother dampingSmoother;
+    DSPUtils::LinearSmoother highPassSmoother;
+    DSPUtils::LinearSmoother lowPassSmoother;
+    DSPUtils::LinearSmoother duckingSmoother;
+    DSPUtils::LinearSmoother mixSmoother { 0.5f };
+    DSPUtils::LinearSmoother widthSmoother { 1.0f };
 
     // Metering
     std::atomic<float> inputLevel { 0.0f };
@@ -119,8 +214,77 @@ private:
     // Playhead info for tempo sync
     double currentBPM = 120.0;
 
+    // Latency of the active engine (the gate lookahead or the reverse
+    // length). Changes are picked up
+    // on the audio thread and passed to the host from the message thread.
+    std::atomic<int> reportedLatency { 0 };
+    int getEngineLatency(ReverbType type) const;
+    void handleAsyncUpdate() override;
+
     // Update reverb parameters from APVTS
     void updateReverbParameters();
 
+    // Host blocks are cut into sub-blocks that end on a fixed grid of the
+    // running sample count, and parameters are re-read between them. A value
+    // that changes while the host is inside a block is picked up at the next
+    // grid point; one the host only supplies at the start of its blocks lands
+    // on the first grid point of the block, so with automation the result
+    // still depends on where the host's blocks begin. The sub-blocks are views
+    // into the host buffer. Parameters are only re-read when one has changed
+    // since the last read.
+    static constexpr int subBlockSize = 32;
+    juce::int64 samplePosition = 0;
+    std::atomic<bool> parametersChanged { true };
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void processSubBlock(juce::AudioBuffer<float>& hostBlock, int start, int numSamples);
+
+    // Routing for the current host block, read by processSubBlock()
+    bool monoSource = false;
+    bool gateKeyed = false;
+    bool duckerKeyed = false;
+    bool ducking = false;
+
+    // Output stage. The engines return only the wet signal; the dry input is
+    // captured here before they run, delayed by the active engine's latency,
+    // and mixed back in with the ducking and width applied to the wet side.
+    // The ducker's key, dry or external, is delayed the same way so the
+    // ducking lines up with the dry signal that is heard. Everything is sized
+    // for a sub-block, so nothing is allocated per block.
+    static constexpr double maxLatencySeconds = 1.0;   // The longest reverse length
+    DSPUtils::BlockDelay dryDelayL;
+    DSPUtils::BlockDelay dryDelayR;
+    DSPUtils::BlockDelay keyDelayL;
+    DSPUtils::BlockDelay keyDelayR;
+    std::array<float, subBlockSize> dryL {};
+    std::array<float, subBlockSize> dryR {};
+    std::array<float, subBlockSize> keyL {};
+    std::array<float, subBlockSize> keyR {};
+
+    // Read head of the dry and key delays. A latency change crossfades from
+    // the old head to the new one over dryFadeMs; a further change waits
+    // until that fade is over.
+    static constexpr float dryFadeMs = 5.0f;
+    int dryLatency = 0;
+    int dryFadeFrom = 0;
+    float dryFade = 1.0f;      // 0-1, 1 when no crossfade is running
+    float dryFadeStep = 1.0f;
+    void setDryLatency(int latency);
+    float nextDryFade();
+    float readDelayed(const DSPUtils::BlockDelay& line, float fade) const;
+    std::array<float, subBlockSize> duckGains {};
+    std::array<float, subBlockSize> mixGains {};
+    std::array<float, subBlockSize> widthGains {};
+    std::array<float, subBlockSize> fadeOutGains {};
+    std::array<float, subBlockSize> fadeInGains {};
+    std::array<float, subBlockSize> tailGains {};
+    void mixOutput(juce::AudioBuffer<float>& wet, int latency);
+
+    // Runs the current engine on buffer and, while crossfading, the target
+    // engine on incoming, in control steps while a glide is moving. The gate
+    // key, when set, lines up with the start of buffer.
+    ReverbBase& getEngine(ReverbType type);
+    void runEngines(juce::AudioBuffer<float>& buffer, juce::AudioBuffer<float>* incoming,
+                    const float* gateKeyL, const float* gateKeyR);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynoverbAudioProcessor)
 };
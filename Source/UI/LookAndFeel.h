@@ -325,3 +325,70 @@ private:
     float decaySeconds = 2.0f;
     bool frozen = false;
 };
+
+// Scrolling spectrogram of the shimmer tank.
+// Columns are written into a cached image as frames arrive; the image is used
+// as a ring buffer and drawn in two pieces so nothing has to be shifted.
+class TankSpectrogram : public juce::Component
+{
+public:
+    void pushFrame(const float* magnitudes, int numBands)
+    {
+        if (image.isNull() || image.getHeight() != numBands)
+        {
+            image = juce::Image(juce::Image::RGB, historyColumns, numBands, true);
+            writeColumn = 0;
+        }
+
+        for (int b = 0; b < numBands; ++b)
+        {
+            float db = juce::Decibels::gainToDecibels(magnitudes[b], -90.0f);
+            float normalized = juce::jlimit(0.0f, 1.0f, juce::jmap(db, -90.0f, -6.0f, 0.0f, 1.0f));
+
+            juce::Colour colour = normalized < 0.5f
+                ? Colors::background.interpolatedWith(Colors::accent, normalized * 2.0f)
+                : Colors::accent.interpolatedWith(Colors::freeze, normalized * 2.0f - 1.0f);
+
+            // Low bands at the bottom
+            image.setPixelAt(writeColumn, numBands - 1 - b, colour);
+        }
+
+        writeColumn = (writeColumn + 1) % historyColumns;
+    }
+
+    void clear()
+    {
+        if (! image.isNull())
+            image.clear(image.getBounds(), Colors::background);
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().reduced(2);
+
+        g.setColour(juce::Colour(0xff151515));
+        g.fillRoundedRectangle(bounds.toFloat(), 3.0f);
+
+        if (! image.isNull())
+        {
+            // Oldest columns (right of the write head) first, newest at the right edge
+            int olderColumns = historyColumns - writeColumn;
+            int splitX = bounds.getX() + bounds.getWidth() * olderColumns / historyColumns;
+
+            g.drawImage(image, bounds.getX(), bounds.getY(), splitX - bounds.getX(), bounds.getHeight(),
+                        writeColumn, 0, olderColumns, image.getHeight());
+            if (writeColumn > 0)
+                g.drawImage(image, splitX, bounds.getY(), bounds.getRight() - splitX, bounds.getHeight(),
+                            0, 0, writeColumn, image.getHeight());
+        }
+
+        g.setColour(Colors::panelBorder);
+        g.drawRoundedRectangle(bounds.toFloat(), 3.0f, 1.0f);
+    }
+
+private:
+    static constexpr int historyColumns = 256;
+
+    juce::Image image;
+    int writeColumn = 0;
+};